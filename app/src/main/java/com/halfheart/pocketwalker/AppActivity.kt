@@ -101,9 +101,13 @@ import com.halfheart.pocketwalkerlib.BUTTON_RIGHT
 import com.halfheart.pocketwalkerlib.PocketWalkerNative
 import com.yourpackage.TcpSocket
 import com.bagboi.pokepaw.R
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
 import kotlinx.coroutines.delay
+import kotlinx.coroutines.isActive
 import kotlinx.coroutines.launch
 
+import java.io.File
 import java.util.function.Function
 import kotlin.concurrent.thread
 import kotlin.experimental.xor
@@ -134,6 +138,14 @@ class AppActivity : ComponentActivity()  {
     )
 
     private val EEPROM_SAVE_FILENAME = "eeprom_pokepal.bin"
+    private val EEPROM_JOURNAL_FILENAME = "eeprom_pokepal.journal"
+
+    // Fold the EEPROM journal back into the save file once it grows past this
+    private val EEPROM_JOURNAL_COMPACT_SIZE = 64 * 1024
+
+    // Bytes from the IR peer held back while the walker's receive ring is
+    // full, past this the oldest are dropped
+    private val IR_RECEIVE_BACKLOG_LIMIT = 64 * 1024
 
     private var didInitialize: Boolean = false
 
@@ -283,6 +295,11 @@ class AppActivity : ComponentActivity()  {
 
         pokeWalker = PocketWalkerNative()
         pokeWalker.create(rom, eeprom)
+        pokeWalker.enableInstantBoot(cacheDir.absolutePath)
+        pokeWalker.enableEepromJournal(
+            File(filesDir, EEPROM_SAVE_FILENAME).absolutePath,
+            File(filesDir, EEPROM_JOURNAL_FILENAME).absolutePath
+        )
 
         val initialColorMode = preferences.getBoolean("colorization_enabled", false)
         pokeWalker.setColorMode(initialColorMode)
@@ -320,10 +337,26 @@ class AppActivity : ComponentActivity()  {
 
         didInitialize = true
         loadUiColorSpritesIfNeeded()
+        startEepromJournalFlusher()
         startWalkerSpriteWatcher()
         startRouteWatcher()
     }
 
+    private fun startEepromJournalFlusher() {
+        if (!::pokeWalker.isInitialized) return
+
+        lifecycleScope.launch(Dispatchers.IO) {
+            while (isActive) {
+                delay(5000L)
+
+                val journalSize = pokeWalker.flushEepromJournal()
+                if (journalSize > EEPROM_JOURNAL_COMPACT_SIZE) {
+                    pokeWalker.compactEepromJournal()
+                }
+            }
+        }
+    }
+
     fun initializeTcp(host: String, port: Int) {
         val socket = TcpSocket()
 
@@ -335,35 +368,72 @@ class AppActivity : ComponentActivity()  {
             println("[TCP] Disconnected")
         }
 
+        // What the walker's receive ring had no room for yet. Only touched on
+        // the main thread, where the socket delivers and the retry runs.
+        var receiveBacklog = ByteArray(0)
+        var receiveRetry: Job? = null
+
+        fun feedReceiveBacklog() {
+            val accepted = pokeWalker.receiveSci3Bytes(receiveBacklog)
+            receiveBacklog = receiveBacklog.copyOfRange(accepted, receiveBacklog.size)
+        }
+
         socket.setOnData { data ->
             data.forEach { byte ->
                 println("RX: %02X".format(byte xor 0xAA.toByte()))
-                pokeWalker.receiveSci3(byte)
+            }
+
+            receiveBacklog += data
+            if (receiveBacklog.size > IR_RECEIVE_BACKLOG_LIMIT) {
+                // The firmware isn't listening, let the oldest bytes overrun
+                receiveBacklog = receiveBacklog.copyOfRange(receiveBacklog.size - IR_RECEIVE_BACKLOG_LIMIT, receiveBacklog.size)
+            }
+
+            feedReceiveBacklog()
+            if (receiveBacklog.isNotEmpty() && receiveRetry?.isActive != true) {
+                receiveRetry = lifecycleScope.launch {
+                    while (receiveBacklog.isNotEmpty()) {
+                        delay(5L)
+                        feedReceiveBacklog()
+                    }
+                }
             }
         }
 
-        pokeWalker.onTransmitSci3 { byte ->
-            println("TX: %02X".format(byte xor 0xAA.toByte()))
-            socket.send(byteArrayOf(byte))
+        pokeWalker.onTransmitSci3 { data ->
+            data.forEach { byte ->
+                println("TX: %02X".format(byte xor 0xAA.toByte()))
+            }
+            socket.send(data)
         }
 
         socket.connect(host, port)
 
-        thread {
-            Thread.sleep(3000)
+        lifecycleScope.launch(Dispatchers.IO) {
+            delay(3000L)
 
-            while (true) {
+            while (isActive) {
                 if (!socket.isConnected() && !socket.isConnecting()) {
                     println("Attempting reconnection...")
                     socket.reconnect()
-                    Thread.sleep(5000)
+                    delay(5000L)
                 } else {
-                    Thread.sleep(1000)
+                    delay(1000L)
                 }
             }
         }
     }
 
+    override fun onPause() {
+        super.onPause()
+
+        // The process may be killed any time after this, don't leave the last
+        // few seconds of EEPROM writes to the periodic flush
+        if (::pokeWalker.isInitialized) {
+            pokeWalker.flushEepromJournal()
+        }
+    }
+
     override fun onCreate(savedInstanceState: Bundle?) {
         super.onCreate(savedInstanceState)
         preferences = getSharedPreferences("pokewalker_prefs", Context.MODE_PRIVATE)
@@ -391,11 +461,13 @@ class AppActivity : ComponentActivity()  {
             }
         }
 
-        // Load internal persistent EEPROM save if it exists
-        if (applicationContext.fileList().contains(EEPROM_SAVE_FILENAME)) {
-            applicationContext.openFileInput(EEPROM_SAVE_FILENAME).use { input ->
-                eepromBytes = input.readBytes()
-            }
+        // Load internal persistent EEPROM save if it exists, with the pages
+        // journaled since it was last written out whole replayed on top
+        PocketWalkerNative().recoverEeprom(
+            File(filesDir, EEPROM_SAVE_FILENAME).absolutePath,
+            File(filesDir, EEPROM_JOURNAL_FILENAME).absolutePath
+        )?.let { bytes ->
+            eepromBytes = bytes
         }
 
         romPickerLauncher = registerForActivityResult(ActivityResultContracts.OpenDocument()) { uri: Uri? ->
@@ -431,6 +503,7 @@ class AppActivity : ComponentActivity()  {
                 applicationContext.openFileOutput(EEPROM_SAVE_FILENAME, MODE_PRIVATE).use { output ->
                     output.write(bytes)
                 }
+                applicationContext.deleteFile(EEPROM_JOURNAL_FILENAME)
             }
 
             preferences.edit().putString("eeprom_uri", uri.toString()).apply()
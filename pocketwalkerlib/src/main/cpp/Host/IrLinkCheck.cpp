@@ -0,0 +1,181 @@
+// Headless check that two walkers talking through an IrLink play out the same
+// way every time. Runs the pair twice from the same ROM and EEPROM images and
+// compares every byte that crossed the link, and when.
+//
+// IrLinkCheck <rom> <eeprom a> <eeprom b> [seconds] [press...]
+//
+// Each press is walker:button:second, e.g. a:center:4.5, held for a tenth of
+// a second, to get the walkers into a connection. The images are only read.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../PocketWalker/PokeWalker/PokeWalker.h"
+#include "../PocketWalker/PokeWalker/IrLink/IrLink.h"
+
+namespace
+{
+    struct Press
+    {
+        uint8_t walker;
+        Buttons::Button button;
+        uint64_t cycle;
+    };
+
+    constexpr uint64_t HOLD_CYCLES = Cpu::TICKS / 10;
+
+    // Both runs see the same wall time, or a second ticking over between
+    // them could change what the firmware does.
+    constexpr std::time_t START_TIME = 1700000000;
+
+    std::vector<uint8_t> ReadImage(const std::filesystem::path& path, const size_t size)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            std::fprintf(stderr, "Can't read %s\n", path.string().c_str());
+            std::exit(2);
+        }
+
+        // Short images are padded the way the app pads them.
+        std::vector<uint8_t> image(size);
+        file.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(size));
+        return image;
+    }
+
+    bool ParsePress(const std::string& argument, Press& press)
+    {
+        const size_t first = argument.find(':');
+        const size_t second = argument.find(':', first + 1);
+        if (first != 1 || second == std::string::npos || (argument[0] != 'a' && argument[0] != 'b'))
+        {
+            return false;
+        }
+
+        const std::string button = argument.substr(first + 1, second - first - 1);
+        if (button == "left") press.button = Buttons::Left;
+        else if (button == "center") press.button = Buttons::Center;
+        else if (button == "right") press.button = Buttons::Right;
+        else return false;
+
+        press.walker = argument[0] == 'a' ? 0 : 1;
+        press.cycle = static_cast<uint64_t>(std::strtod(argument.c_str() + second + 1, nullptr) * Cpu::TICKS);
+        return true;
+    }
+
+    std::vector<IrLink::Delivery> Run(const std::vector<uint8_t>& rom, const std::vector<uint8_t>& eepromA, const std::vector<uint8_t>& eepromB, const uint64_t cycles, const std::vector<Press>& presses)
+    {
+        // The firmware writes to both, every run starts from fresh copies.
+        std::vector<uint8_t> romA = rom;
+        std::vector<uint8_t> romB = rom;
+        std::vector<uint8_t> eepromCopyA = eepromA;
+        std::vector<uint8_t> eepromCopyB = eepromB;
+
+        PokeWalker a(romA.data(), eepromCopyA.data());
+        PokeWalker b(romB.data(), eepromCopyB.data());
+        PokeWalker* walkers[] = { &a, &b };
+
+        for (PokeWalker* walker : walkers)
+        {
+            // Emulated time, so the RTC keeps pace with the firmware.
+            walker->SetClock([walker] { return START_TIME + static_cast<std::time_t>(walker->GetElapsedCycles() / Cpu::TICKS); });
+        }
+
+        IrLink link(&a, &b);
+
+        std::vector<IrLink::Delivery> trace;
+        link.OnDeliver += [&trace](const IrLink::Delivery& delivery)
+        {
+            trace.push_back(delivery);
+        };
+
+        for (const Press& press : presses)
+        {
+            if (press.cycle > link.Now())
+            {
+                link.Run(std::min(press.cycle, cycles) - link.Now());
+            }
+
+            walkers[press.walker]->PressButton(press.button);
+            link.Run(HOLD_CYCLES);
+            walkers[press.walker]->ReleaseButton(press.button);
+        }
+
+        if (cycles > link.Now())
+        {
+            link.Run(cycles - link.Now());
+        }
+
+        return trace;
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::fprintf(stderr, "Usage: %s <rom> <eeprom a> <eeprom b> [seconds] [walker:button:second...]\n", argv[0]);
+        return 2;
+    }
+
+    const std::vector<uint8_t> rom = ReadImage(argv[1], Board::RAM_SIZE);
+    const std::vector<uint8_t> eepromA = ReadImage(argv[2], Eeprom::MEMORY_SIZE);
+    const std::vector<uint8_t> eepromB = ReadImage(argv[3], Eeprom::MEMORY_SIZE);
+    const double seconds = argc > 4 ? std::strtod(argv[4], nullptr) : 30.0;
+    const uint64_t cycles = static_cast<uint64_t>(seconds * Cpu::TICKS);
+
+    std::vector<Press> presses;
+    for (int index = 5; index < argc; index++)
+    {
+        Press press{};
+        if (!ParsePress(argv[index], press))
+        {
+            std::fprintf(stderr, "Bad press %s, expected walker:button:second with walker a or b and button left, center or right\n", argv[index]);
+            return 2;
+        }
+
+        presses.push_back(press);
+    }
+
+    std::ranges::stable_sort(presses, {}, &Press::cycle);
+
+    std::vector<IrLink::Delivery> first;
+    std::vector<IrLink::Delivery> second;
+    try
+    {
+        first = Run(rom, eepromA, eepromB, cycles, presses);
+        second = Run(rom, eepromA, eepromB, cycles, presses);
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    const auto [firstMismatch, secondMismatch] = std::ranges::mismatch(first, second);
+    if (firstMismatch != first.end() || secondMismatch != second.end())
+    {
+        const size_t index = static_cast<size_t>(firstMismatch - first.begin());
+        std::fprintf(stderr, "Runs differ at byte %zu of %zu/%zu\n", index, first.size(), second.size());
+        return 1;
+    }
+
+    if (first.empty())
+    {
+        std::printf("No bytes crossed the link in %.1f seconds\n", seconds);
+    }
+    else
+    {
+        std::printf("%zu bytes crossed the link, the same in both runs, the last at cycle %llu\n", first.size(), static_cast<unsigned long long>(first.back().cycle));
+    }
+
+    return 0;
+}
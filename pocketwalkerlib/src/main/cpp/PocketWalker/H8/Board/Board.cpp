@@ -1,34 +1,89 @@
-
 #include <print>
 #include "Board.h"
 
 #include "../Rtc/Rtc.h"
+#include "../../Utilities/StateSerializer.h"
 
 
-void Board::Tick(uint64_t cycles)
+void Board::ScheduleComponents()
 {
-    if (cycles % ssu->clockRate == 0)
+    // Only runs while a byte is in flight.
+    ssuEvent = scheduler->AddOneShot([this]()
     {
-        ssu->Tick();
-    }
-    
-    if (cycles % (Cpu::TICKS / Timer::TICKS) == 0)
+        ssu->CompleteTransfer();
+    });
+
+    ssu->OnTransmit += [this](const size_t cycles)
+    {
+        // A second write mid-byte doesn't restart it.
+        if (scheduler->Deadline(ssuEvent) == UINT64_MAX)
+        {
+            scheduler->Schedule(ssuEvent, scheduler->Now() + cycles);
+        }
+    };
+
+    scheduler->AddPeriodic(Cpu::TICKS / Timer::TICKS, [this]()
     {
         timer->Tick();
-    }
+    });
 
-    if (cycles % (Cpu::TICKS / Sci3::TICKS) == 0 && timer->clockStop1 & TimerFlags::STANDBY_SCI3)
+    scheduler->AddPeriodic(Cpu::TICKS / Sci3::TICKS, [this]()
     {
-        sci3->Tick();
-    }
-    
-    if (cycles % (Cpu::TICKS / Adc::TICKS) == 0 && timer->clockStop1 & TimerFlags::STANDBY_ADC)
+        if (timer->clockStop1 & TimerFlags::STANDBY_SCI3)
+        {
+            sci3->Tick();
+        }
+    });
+
+    scheduler->AddPeriodic(Cpu::TICKS / Adc::TICKS, [this]()
     {
-        adc->Tick();
-    }
+        if (timer->clockStop1 & TimerFlags::STANDBY_ADC)
+        {
+            adc->Tick();
+        }
+    });
+
+    scheduler->AddPeriodic(Cpu::TICKS / Rtc::TICKS, [this]()
+    {
+        if (timer->clockStop1 & TimerFlags::STANDBY_RTC)
+        {
+            rtc->Tick();
+        }
+    });
+}
+
+void Board::SaveState(StateWriter& writer) const
+{
+    writer.WriteMemory(ram, RAM_SIZE);
 
-    if (cycles % (Cpu::TICKS / Rtc::TICKS) == 0 && timer->clockStop1 & TimerFlags::STANDBY_RTC)
+    cpu->SaveState(writer);
+    ssu->SaveState(writer);
+    writer.Write(scheduler->Deadline(ssuEvent));
+    sci3->SaveState(writer);
+    timer->SaveState(writer);
+    rtc->SaveState(writer);
+}
+
+void Board::LoadState(StateReader& reader)
+{
+    reader.ReadMemory(ram, RAM_SIZE);
+
+    cpu->LoadState(reader);
+    ssu->LoadState(reader);
+    const uint64_t ssuDeadline = reader.Read<uint64_t>();
+    if (ssuDeadline == UINT64_MAX)
+    {
+        scheduler->Cancel(ssuEvent);
+    }
+    else
     {
-        rtc->Tick();
+        scheduler->Schedule(ssuEvent, ssuDeadline);
     }
+
+    sci3->LoadState(reader);
+    timer->LoadState(reader);
+    rtc->LoadState(reader);
+
+    // The registers were restored without going through their write hooks.
+    cpu->interrupts->UpdatePending();
 }
@@ -11,31 +11,39 @@
 #include "../Sci3/Sci3.h"
 #include "../Ssu/Ssu.h"
 #include "../Timers/Timer.h"
+#include "Scheduler.h"
 
 class Adc;
 class Lcd;
 class Cpu;
 class Ssu;
 class Memory;
+class StateWriter;
+class StateReader;
 
 class Board
 {
 public:
-    Board(uint8_t* ramBuffer)
+    Board(uint8_t* ramBuffer, const ExecutionMode executionMode = ExecutionMode::Interpreter)
     {
         ram = new Memory(ramBuffer);
         ram->name = "Ram";
         
-        cpu = new Cpu(ram);
+        cpu = new Cpu(ram, executionMode);
         ssu = new Ssu(ram, cpu->interrupts, cpu->flags);
         sci3 = new Sci3(ram);
         adc = new Adc(ram);
         timer = new Timer(ram, cpu->interrupts);
         rtc = new Rtc(ram, cpu->interrupts);
 
+        scheduler = new Scheduler();
+        ScheduleComponents();
     }
- 
-    void Tick(uint64_t cycles);
+
+    // RAM and every on-chip peripheral, the scheduler is restarted by the
+    // owner once the cycle count is known.
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
 
     Memory* ram;
     Cpu* cpu;
@@ -44,4 +52,13 @@ public:
     Timer* timer;
     Rtc* rtc;
     Adc* adc;
+    Scheduler* scheduler;
+
+    // Size of the buffer backing ram, the whole 16-bit space but the last byte.
+    static constexpr size_t RAM_SIZE = 0xFFFF;
+
+private:
+    void ScheduleComponents();
+
+    Scheduler::EventId ssuEvent;
 };
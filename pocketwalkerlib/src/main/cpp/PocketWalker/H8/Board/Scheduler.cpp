@@ -0,0 +1,105 @@
+#include "Scheduler.h"
+
+Scheduler::EventId Scheduler::AddPeriodic(const uint64_t period, const ScheduledCallback& callback)
+{
+    const EventId id = static_cast<EventId>(events.size());
+    events.push_back({ period, 0, 0, callback });
+
+    Push(id, (now / period + 1) * period);
+
+    return id;
+}
+
+void Scheduler::SetPeriod(const EventId id, const uint64_t period)
+{
+    Event& event = events[id];
+    const uint64_t deadline = (now / period + 1) * period;
+
+    event.period = period;
+    if (deadline != event.deadline)
+    {
+        Push(id, deadline);
+    }
+}
+
+Scheduler::EventId Scheduler::AddOneShot(const ScheduledCallback& callback)
+{
+    const EventId id = static_cast<EventId>(events.size());
+    events.push_back({ 0, UINT64_MAX, 0, callback });
+
+    return id;
+}
+
+void Scheduler::Schedule(const EventId id, const uint64_t deadline)
+{
+    Push(id, deadline);
+}
+
+void Scheduler::Cancel(const EventId id)
+{
+    // The queued entry is skipped once its sequence no longer matches.
+    events[id].deadline = UINT64_MAX;
+    events[id].sequence++;
+}
+
+void Scheduler::Restart(const uint64_t cycles)
+{
+    now = cycles;
+    queue = {};
+    nextDeadline = UINT64_MAX;
+
+    for (EventId id = 0; id < events.size(); id++)
+    {
+        const Event& event = events[id];
+        if (event.period != 0)
+        {
+            Push(id, (now / event.period + 1) * event.period);
+        }
+        else if (event.deadline != UINT64_MAX)
+        {
+            Push(id, event.deadline);
+        }
+    }
+}
+
+void Scheduler::Push(const EventId id, const uint64_t deadline)
+{
+    Event& event = events[id];
+
+    // Any older entry for this event is left in the queue and skipped once
+    // its sequence no longer matches.
+    event.deadline = deadline;
+    event.sequence++;
+
+    queue.push({ deadline, id, event.sequence });
+    nextDeadline = queue.top().deadline;
+}
+
+void Scheduler::Fire(const uint64_t cycles)
+{
+    while (!queue.empty() && queue.top().deadline <= cycles)
+    {
+        const Entry entry = queue.top();
+        queue.pop();
+
+        Event& event = events[entry.id];
+        if (entry.sequence != event.sequence)
+        {
+            continue;
+        }
+
+        now = entry.deadline;
+        if (event.period != 0)
+        {
+            Push(entry.id, entry.deadline + event.period);
+        }
+        else
+        {
+            event.deadline = UINT64_MAX;
+        }
+
+        event.callback();
+    }
+
+    nextDeadline = queue.empty() ? UINT64_MAX : queue.top().deadline;
+}
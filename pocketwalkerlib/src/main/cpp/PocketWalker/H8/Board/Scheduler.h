@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+using ScheduledCallback = std::function<void()>;
+
+// Keeps the peripherals on one cycle timeline. Each event sits in a min-heap
+// keyed on the absolute cycle it is next due, so the main loop only has to
+// compare the cycle count against the earliest deadline after each
+// instruction.
+class Scheduler
+{
+public:
+    using EventId = uint32_t;
+
+    // Fires on every multiple of period, like the old cycles % period checks.
+    // Events due on the same cycle fire in the order they were added.
+    EventId AddPeriodic(uint64_t period, const ScheduledCallback& callback);
+
+    // Takes effect from the next multiple of the new period after the
+    // current cycle.
+    void SetPeriod(EventId id, uint64_t period);
+
+    // Only fires once armed with Schedule, and once per arming.
+    EventId AddOneShot(const ScheduledCallback& callback);
+
+    // Arms a one shot event for the given cycle, replacing any earlier
+    // arming. Cancel disarms it.
+    void Schedule(EventId id, uint64_t deadline);
+    void Cancel(EventId id);
+
+    // When a one shot event is armed for, UINT64_MAX if it isn't.
+    uint64_t Deadline(const EventId id) const { return events[id].deadline; }
+
+    // Jumps the timeline to cycles without firing anything, every periodic
+    // event is due again on the next multiple of its period. Armed one shot
+    // events keep their deadline.
+    void Restart(uint64_t cycles);
+
+    // Moves the timeline up to cycles, firing everything due on the way.
+    void Advance(uint64_t cycles)
+    {
+        if (cycles >= nextDeadline)
+        {
+            Fire(cycles);
+        }
+
+        now = cycles;
+    }
+
+    uint64_t Now() const { return now; }
+    uint64_t NextDeadline() const { return nextDeadline; }
+
+private:
+    struct Event
+    {
+        // 0 for one shot events.
+        uint64_t period;
+        uint64_t deadline;
+        uint32_t sequence;
+        ScheduledCallback callback;
+    };
+
+    struct Entry
+    {
+        uint64_t deadline;
+        EventId id;
+        uint32_t sequence;
+
+        bool operator>(const Entry& other) const
+        {
+            return deadline != other.deadline ? deadline > other.deadline : id > other.id;
+        }
+    };
+
+    void Fire(uint64_t cycles);
+    void Push(EventId id, uint64_t deadline);
+
+    std::vector<Event> events;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+
+    uint64_t now = 0;
+    uint64_t nextDeadline = UINT64_MAX;
+};
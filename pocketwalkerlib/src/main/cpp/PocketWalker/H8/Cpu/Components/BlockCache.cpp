@@ -0,0 +1,505 @@
+#include "BlockCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include "../Cpu.h"
+
+BlockCache::BlockCache(Cpu* cpu) : cpu(cpu)
+{
+    isChecking = cpu->executionMode == ExecutionMode::BlockCacheVerify;
+
+#if defined(__x86_64__)
+    if (cpu->executionMode == ExecutionMode::Recompiler || cpu->executionMode == ExecutionMode::RecompilerVerify)
+    {
+        recompiler = new Recompiler(cpu, &BlockCache::Fallback);
+        verify = cpu->executionMode == ExecutionMode::RecompilerVerify;
+
+        // No executable memory, stay on plain blocks.
+        if (!recompiler->Available())
+        {
+            delete recompiler;
+            recompiler = nullptr;
+        }
+    }
+#endif
+    
+    cpu->ram->OnAnyWrite([this](const uint16_t address, const size_t size)
+    {
+        if (codePages[address >> 8] || codePages[static_cast<uint16_t>(address + size - 1) >> 8])
+        {
+            Flush();
+        }
+    });
+}
+
+size_t BlockCache::Execute()
+{
+    // Blocks dropped by a flush may still have been running, so they are only
+    // freed once we're back out here.
+    for (const Block* block : retired)
+    {
+        delete block;
+    }
+    retired.clear();
+    
+    const uint16_t address = cpu->registers->pc;
+    const uint32_t startGeneration = generation;
+
+    Block* block = previous != nullptr ? previous->next : nullptr;
+    if (block == nullptr || block->address != address)
+    {
+        block = blocks[address >> 1];
+    }
+
+    size_t cycles;
+    if (block != nullptr)
+    {
+        cycles = Run(block);
+    }
+    else
+    {
+        block = new Block(address);
+        cycles = Record(block);
+    }
+
+    // A flush while running retired this block, and it is freed on the next
+    // call, so don't chain from it.
+    if (generation != startGeneration)
+    {
+        previous = nullptr;
+        return cycles;
+    }
+
+    if (previous != nullptr)
+    {
+        previous->next = block;
+    }
+    previous = block;
+
+    return cycles;
+}
+
+void BlockCache::Flush()
+{
+    for (Block*& block : blocks)
+    {
+        if (block != nullptr)
+        {
+            retired.push_back(block);
+            block = nullptr;
+        }
+    }
+
+    codePages.reset();
+    previous = nullptr;
+    generation++;
+
+#if defined(__x86_64__)
+    // Anything still running was emitted before this point and stays intact
+    // until the next compile, which only happens back in Execute.
+    if (recompiler != nullptr)
+    {
+        recompiler->Reset();
+    }
+#endif
+}
+
+void BlockCache::Invalidate(const uint16_t address)
+{
+    // The longest block can't start further back than this.
+    constexpr size_t reach = MAX_BLOCK_LENGTH * sizeof(BlockOp::bytes);
+    const size_t first = address > reach ? (address - reach) >> 1 : 0;
+
+    std::vector<Block*> dropped;
+    for (size_t index = first; index <= address >> 1; index++)
+    {
+        Block*& block = blocks[index];
+        if (block != nullptr && std::ranges::any_of(block->ops, [address](const BlockOp& op) { return op.address == address; }))
+        {
+            dropped.push_back(block);
+            retired.push_back(block);
+            block = nullptr;
+        }
+    }
+
+    if (dropped.empty())
+    {
+        return;
+    }
+
+    // Nothing may chain into them any more.
+    for (Block* block : blocks)
+    {
+        if (block != nullptr && std::ranges::find(dropped, block->next) != dropped.end())
+        {
+            block->next = nullptr;
+        }
+    }
+
+    if (std::ranges::find(dropped, previous) != dropped.end())
+    {
+        previous = nullptr;
+    }
+
+    // Whatever is running right now stops after its current op.
+    generation++;
+}
+
+bool BlockCache::Fallback(Cpu* cpu, const BlockOp* op)
+{
+    BlockCache* cache = cpu->blockCache;
+
+    // Exceptions can't unwind through generated code, so they're carried
+    // out and rethrown once it has returned.
+    try
+    {
+        cpu->opcodes->Load(op->address, op->bytes);
+        cpu->instructions->Execute(cpu, op->instruction);
+        cpu->instructionCount++;
+
+        // Generated code works on the ccr byte directly.
+        cpu->flags->Resolve();
+    }
+    catch (...)
+    {
+        cache->pendingException = std::current_exception();
+        return false;
+    }
+
+    return cpu->registers->pc == static_cast<uint16_t>(op->address + op->instruction->bytes) && !cpu->sleeping && cache->generation == cache->runGeneration;
+}
+
+size_t BlockCache::Run(Block* block)
+{
+    if (isChecking)
+    {
+        return RunChecked(block);
+    }
+
+#if defined(__x86_64__)
+    if (recompiler != nullptr)
+    {
+        if (block->compiled == nullptr && ++block->runs == HOT_BLOCK_RUNS)
+        {
+            Compile(block);
+        }
+
+        if (block->compiled != nullptr)
+        {
+            return verify ? RunVerified(block) : RunCompiled(block);
+        }
+    }
+#endif
+
+    return Interpret(block);
+}
+
+size_t BlockCache::Interpret(const Block* block)
+{
+    const uint32_t startGeneration = generation;
+    size_t cycles = 0;
+    
+    for (const BlockOp& op : block->ops)
+    {
+        cpu->opcodes->Load(op.address, op.bytes);
+        cpu->instructions->Execute(cpu, op.instruction);
+        cpu->instructionCount++;
+        cycles += op.instruction->cycles;
+
+        if (cpu->registers->pc != static_cast<uint16_t>(op.address + op.instruction->bytes) || cpu->sleeping || generation != startGeneration)
+        {
+            break;
+        }
+    }
+
+    return cycles;
+}
+
+size_t BlockCache::Record(Block* block)
+{
+    const uint32_t startGeneration = generation;
+    size_t cycles = 0;
+
+    while (true)
+    {
+        BlockOp op;
+        op.address = cpu->registers->pc;
+        
+        for (uint16_t offset = 0; offset < sizeof(op.bytes); offset++)
+        {
+            op.bytes[offset] = cpu->ram->buffer[static_cast<uint16_t>(op.address + offset)];
+        }
+
+        // Marked before running so a write over these bytes, even by this
+        // very op, flushes the block we're building.
+        codePages[op.address >> 8] = true;
+        codePages[static_cast<uint16_t>(op.address + sizeof(op.bytes) - 1) >> 8] = true;
+
+        cpu->opcodes->Load(op.address, op.bytes);
+        op.instruction = cpu->instructions->Decode(cpu->opcodes);
+
+        // Let the next step report an invalid opcode on its own.
+        if (op.instruction == nullptr && !block->ops.empty())
+        {
+            break;
+        }
+
+        cpu->instructions->Execute(cpu, op.instruction);
+        cpu->instructionCount++;
+        cycles += op.instruction->cycles;
+
+        block->ops.push_back(op);
+
+        const uint16_t next = static_cast<uint16_t>(op.address + op.instruction->bytes);
+        if (cpu->registers->pc != next || cpu->sleeping || generation != startGeneration)
+        {
+            break;
+        }
+
+        if (block->ops.size() == MAX_BLOCK_LENGTH || next & 1 || blocks[next >> 1] != nullptr || cpu->HasAddressHandler(next))
+        {
+            break;
+        }
+    }
+
+    // Something wrote over code while we were recording, the ops may already
+    // be stale.
+    if (generation != startGeneration)
+    {
+        retired.push_back(block);
+        return cycles;
+    }
+
+    blocks[block->address >> 1] = block;
+    return cycles;
+}
+
+size_t BlockCache::RunChecked(const Block* block)
+{
+    Registers* registers = cpu->registers;
+    Flags* flags = cpu->flags;
+    Memory* ram = cpu->ram;
+
+    flags->Resolve();
+
+    uint8_t registersBefore[32];
+    std::memcpy(registersBefore, registers->buffer, sizeof(registersBefore));
+    const uint8_t ccrBefore = flags->ccr;
+    const uint16_t pcBefore = registers->pc;
+    const size_t countBefore = cpu->instructionCount;
+    memoryBefore.assign(ram->buffer, ram->buffer + CHECKED_MEMORY_SIZE);
+
+    // The plain interpreter goes first, decoding straight from memory and
+    // working out every flag as it goes, with memory silenced so the devices
+    // only see the real run below.
+    ram->SetSilent(true);
+    flags->SetLazy(false);
+
+    size_t expectedCycles = 0;
+    bool isComparable = true;
+    try
+    {
+        for (size_t index = 0; index < block->ops.size(); index++)
+        {
+            const uint16_t address = registers->pc;
+            cpu->opcodes->Update(address);
+            const Instruction* instruction = cpu->instructions->Decode(cpu->opcodes);
+            cpu->instructions->Execute(cpu, instruction);
+            cpu->instructionCount++;
+            expectedCycles += instruction->cycles;
+
+            if (registers->pc != static_cast<uint16_t>(address + instruction->bytes) || cpu->sleeping)
+            {
+                break;
+            }
+        }
+    }
+    catch (...)
+    {
+        // The real run throws too if the fault is genuine.
+        isComparable = false;
+    }
+
+    // Devices would have answered differently, so only blocks that never
+    // touch a register with a handler can be compared.
+    isComparable = isComparable && ram->IOAccesses() == 0;
+    ram->SetSilent(false);
+
+    uint8_t expectedRegisters[32];
+    std::memcpy(expectedRegisters, registers->buffer, sizeof(expectedRegisters));
+    const uint8_t expectedCcr = flags->ccr;
+    const uint16_t expectedPc = registers->pc;
+    const size_t expectedCount = cpu->instructionCount;
+    const bool expectedSleeping = cpu->sleeping;
+    checkedMemory.assign(ram->buffer, ram->buffer + CHECKED_MEMORY_SIZE);
+
+    // Only the bytes the interpreter wrote are put back, behind the
+    // observers' backs as they never saw the writes. Code it overwrote would
+    // have flushed the block, so the two runs aren't doing the same thing
+    // any more.
+    for (size_t address = 0; address < CHECKED_MEMORY_SIZE; address++)
+    {
+        if (checkedMemory[address] != memoryBefore[address])
+        {
+            ram->buffer[address] = memoryBefore[address];
+            isComparable = isComparable && !codePages[address >> 8];
+        }
+    }
+
+    std::memcpy(registers->buffer, registersBefore, sizeof(registersBefore));
+    flags->ccr = ccrBefore;
+    flags->SetLazy(true);
+    registers->pc = pcBefore;
+    cpu->instructionCount = countBefore;
+    cpu->sleeping = false;
+
+    const size_t cycles = Interpret(block);
+    flags->Resolve();
+
+    if (!isComparable)
+    {
+        return cycles;
+    }
+
+    if (cycles != expectedCycles || registers->pc != expectedPc || flags->ccr != expectedCcr || cpu->instructionCount != expectedCount || cpu->sleeping != expectedSleeping || std::memcmp(registers->buffer, expectedRegisters, sizeof(expectedRegisters)) != 0)
+    {
+        throw std::runtime_error(std::format("Block at 0x{:04X} does not match the interpreter (pc 0x{:04X}/0x{:04X}, ccr 0x{:02X}/0x{:02X}, cycles {}/{})", block->address, registers->pc, expectedPc, flags->ccr, expectedCcr, cycles, expectedCycles));
+    }
+
+    for (size_t address = 0; address < CHECKED_MEMORY_SIZE; address++)
+    {
+        if (ram->buffer[address] != checkedMemory[address])
+        {
+            throw std::runtime_error(std::format("Block at 0x{:04X} does not match the interpreter (0x{:04X} 0x{:02X}/0x{:02X})", block->address, address, ram->buffer[address], checkedMemory[address]));
+        }
+    }
+
+    return cycles;
+}
+
+#if defined(__x86_64__)
+void BlockCache::Compile(Block* block)
+{
+    block->compiled = recompiler->Compile(block);
+
+    if (block->compiled != nullptr && verify)
+    {
+        for (const BlockOp& op : block->ops)
+        {
+            CompiledOp compiledOp = nullptr;
+            if (Recompiler::IsNative(op) && (compiledOp = recompiler->CompileOp(op)) == nullptr)
+            {
+                block->compiled = nullptr;
+                break;
+            }
+
+            block->compiledOps.push_back(compiledOp);
+        }
+    }
+
+    // Out of code space. Start over, this block gets recompiled once it's
+    // hot again.
+    if (block->compiled == nullptr)
+    {
+        Flush();
+    }
+}
+
+size_t BlockCache::RunCompiled(const Block* block)
+{
+    runGeneration = generation;
+    cpu->flags->Resolve();
+    const size_t cycles = block->compiled(cpu, block->ops.data());
+
+    if (pendingException != nullptr)
+    {
+        const std::exception_ptr exception = pendingException;
+        pendingException = nullptr;
+        std::rethrow_exception(exception);
+    }
+
+    return cycles;
+}
+
+size_t BlockCache::RunVerified(const Block* block)
+{
+    Registers* registers = cpu->registers;
+    Flags* flags = cpu->flags;
+
+    uint8_t registersBefore[32];
+    std::memcpy(registersBefore, registers->buffer, sizeof(registersBefore));
+    flags->Resolve();
+    const uint8_t ccrBefore = flags->ccr;
+    const uint16_t pcBefore = registers->pc;
+    const size_t countBefore = cpu->instructionCount;
+
+    // Blocks made only of native ops can't touch memory, so the whole block
+    // is run both ways from the same state, exits and cycle counts included.
+    if (std::ranges::all_of(block->ops, Recompiler::IsNative))
+    {
+        const size_t cycles = RunCompiled(block);
+
+        uint8_t registersCompiled[32];
+        std::memcpy(registersCompiled, registers->buffer, sizeof(registersCompiled));
+        const uint8_t ccrCompiled = flags->ccr;
+        const uint16_t pcCompiled = registers->pc;
+        const size_t countCompiled = cpu->instructionCount;
+
+        std::memcpy(registers->buffer, registersBefore, sizeof(registersBefore));
+        flags->ccr = ccrBefore;
+        registers->pc = pcBefore;
+        cpu->instructionCount = countBefore;
+
+        const size_t expectedCycles = Interpret(block);
+        flags->Resolve();
+
+        if (cycles != expectedCycles || pcCompiled != registers->pc || ccrCompiled != flags->ccr || countCompiled != cpu->instructionCount || std::memcmp(registersCompiled, registers->buffer, sizeof(registersCompiled)) != 0)
+        {
+            throw std::runtime_error(std::format("Recompiled block at 0x{:04X} does not match the interpreter (pc 0x{:04X}/0x{:04X}, ccr 0x{:02X}/0x{:02X}, cycles {}/{})", block->address, pcCompiled, registers->pc, ccrCompiled, flags->ccr, cycles, expectedCycles));
+        }
+
+        return cycles;
+    }
+
+    // Otherwise every native op is checked on its own against a scratch copy
+    // of the state it starts from, while the interpreter does the real work.
+    const uint32_t startGeneration = generation;
+    size_t cycles = 0;
+
+    for (size_t index = 0; index < block->ops.size(); index++)
+    {
+        const BlockOp& op = block->ops[index];
+        const CompiledOp compiledOp = block->compiledOps[index];
+
+        uint8_t registersCompiled[32];
+        uint8_t ccrCompiled = flags->ccr;
+        uint16_t pcCompiled = registers->pc;
+        if (compiledOp != nullptr)
+        {
+            std::memcpy(registersCompiled, registers->buffer, sizeof(registersCompiled));
+            compiledOp(registersCompiled, &ccrCompiled, &pcCompiled);
+        }
+
+        cpu->opcodes->Load(op.address, op.bytes);
+        cpu->instructions->Execute(cpu, op.instruction);
+        cpu->instructionCount++;
+        cycles += op.instruction->cycles;
+        flags->Resolve();
+
+        if (compiledOp != nullptr && (pcCompiled != registers->pc || ccrCompiled != flags->ccr || std::memcmp(registersCompiled, registers->buffer, sizeof(registersCompiled)) != 0))
+        {
+            throw std::runtime_error(std::format("Recompiled {} at 0x{:04X} does not match the interpreter (pc 0x{:04X}/0x{:04X}, ccr 0x{:02X}/0x{:02X})", op.instruction->name, op.address, pcCompiled, registers->pc, ccrCompiled, flags->ccr));
+        }
+
+        if (registers->pc != static_cast<uint16_t>(op.address + op.instruction->bytes) || cpu->sleeping || generation != startGeneration)
+        {
+            break;
+        }
+    }
+
+    return cycles;
+}
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <exception>
+#include <vector>
+
+#include "../Recompiler/Recompiler.h"
+
+class Cpu;
+struct Instruction;
+
+// An instruction with its opcode bytes bound in, ready to run without a
+// decode or a memory read.
+struct BlockOp
+{
+    Instruction* instruction;
+    uint16_t address;
+    uint8_t bytes[8];
+};
+
+// A straight run of instructions starting at address. Recorded the first time
+// it runs and left early whenever an instruction moves pc somewhere other than
+// the next op.
+struct Block
+{
+    explicit Block(const uint16_t address) : address(address) { }
+
+    uint16_t address;
+    std::vector<BlockOp> ops;
+
+    // The block control went to the last time this one finished. Static
+    // targets (BRA d:8, Bcc d:16, JMP @aa:24) always hit it.
+    Block* next = nullptr;
+
+#if defined(__x86_64__)
+    size_t runs = 0;
+    CompiledBlock compiled = nullptr;
+    // Only filled in verify mode, nullptr for ops left to the interpreter.
+    std::vector<CompiledOp> compiledOps;
+#endif
+};
+
+class BlockCache
+{
+public:
+    BlockCache(Cpu* cpu);
+
+    // Runs the block at pc, recording it first if needed. Returns the cycles
+    // spent.
+    size_t Execute();
+
+    void Flush();
+
+    // Drops just the blocks that run through address, for a new hook there.
+    void Invalidate(uint16_t address);
+
+    // Runs one op from compiled code. False means the block has to stop here.
+    static bool Fallback(Cpu* cpu, const BlockOp* op);
+
+    static constexpr size_t MAX_BLOCK_LENGTH = 64;
+
+    // How much of memory BlockCacheVerify compares, the board's RAM.
+    static constexpr size_t CHECKED_MEMORY_SIZE = 0xFFFF;
+    static constexpr size_t HOT_BLOCK_RUNS = 32;
+
+private:
+    size_t Run(Block* block);
+    size_t Interpret(const Block* block);
+    size_t Record(Block* block);
+    size_t RunChecked(const Block* block);
+
+#if defined(__x86_64__)
+    void Compile(Block* block);
+    size_t RunCompiled(const Block* block);
+    size_t RunVerified(const Block* block);
+
+    Recompiler* recompiler = nullptr;
+    bool verify = false;
+#endif
+
+    Cpu* cpu;
+
+    // BlockCacheVerify. Memory as the interpreter left it, and as it was
+    // before, kept around between blocks to save the allocations.
+    bool isChecking = false;
+    std::vector<uint8_t> checkedMemory;
+    std::vector<uint8_t> memoryBefore;
+
+    std::array<Block*, 0x8000> blocks{};
+    std::bitset<0x100> codePages;
+
+    Block* previous = nullptr;
+    std::vector<Block*> retired;
+    uint32_t generation = 0;
+    uint32_t runGeneration = 0;
+    std::exception_ptr pendingException;
+};
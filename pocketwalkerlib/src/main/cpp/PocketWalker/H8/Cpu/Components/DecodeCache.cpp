@@ -0,0 +1,61 @@
+#include "DecodeCache.h"
+
+#include "Opcode.h"
+#include "../Instructions/InstructionTable.h"
+#include "../../Memory/Memory.h"
+
+DecodeCache::DecodeCache(Memory* ram, InstructionTable* instructions) : ram(ram), instructions(instructions)
+{
+    ram->OnAnyWrite([this](const uint16_t address, const size_t size)
+    {
+        Invalidate(address, size);
+    });
+}
+
+Instruction* DecodeCache::Fetch(const uint16_t address, Opcode* opcode)
+{
+    // Odd addresses are never valid code, leave them to the slow path so it
+    // reports them the same way as before.
+    if (address & 1)
+    {
+        opcode->Update(address);
+        return instructions->Decode(opcode);
+    }
+
+    DecodedInstruction& entry = entries[address >> 1];
+    if (entry.instruction == nullptr)
+    {
+        for (uint16_t offset = 0; offset < sizeof(entry.bytes); offset++)
+        {
+            entry.bytes[offset] = ram->buffer[static_cast<uint16_t>(address + offset)];
+        }
+
+        opcode->Load(address, entry.bytes);
+        entry.instruction = instructions->Decode(opcode);
+
+        return entry.instruction;
+    }
+
+    opcode->Load(address, entry.bytes);
+    return entry.instruction;
+}
+
+void DecodeCache::Invalidate(const uint16_t address, const size_t size)
+{
+    // Any entry whose eight bytes overlap the write is stale.
+    const int first = (address - 6) & ~1;
+    const int last = address + static_cast<int>(size) - 1;
+
+    for (int entryAddress = first; entryAddress <= last; entryAddress += 2)
+    {
+        entries[static_cast<uint16_t>(entryAddress) >> 1].instruction = nullptr;
+    }
+}
+
+void DecodeCache::Flush()
+{
+    for (DecodedInstruction& entry : entries)
+    {
+        entry.instruction = nullptr;
+    }
+}
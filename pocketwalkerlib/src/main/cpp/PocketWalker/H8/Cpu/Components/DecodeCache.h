@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class Memory;
+class Opcode;
+class InstructionTable;
+struct Instruction;
+
+// One entry per even address. The raw bytes are all the handlers need, the
+// Opcode accessors pull registers, immediates and displacements out of them.
+struct DecodedInstruction
+{
+    Instruction* instruction = nullptr;
+    uint8_t bytes[8];
+};
+
+class DecodeCache
+{
+public:
+    DecodeCache(Memory* ram, InstructionTable* instructions);
+
+    // Loads the opcode at address into opcode and returns its instruction,
+    // decoding only on the first visit. Returns nullptr for invalid opcodes.
+    Instruction* Fetch(uint16_t address, Opcode* opcode);
+
+    void Invalidate(uint16_t address, size_t size);
+    void Flush();
+
+private:
+    Memory* ram;
+    InstructionTable* instructions;
+
+    std::array<DecodedInstruction, 0x8000> entries{};
+};
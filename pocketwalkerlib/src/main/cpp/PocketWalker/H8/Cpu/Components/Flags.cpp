@@ -1 +1,25 @@
-#include "Flags.h"
\ No newline at end of file
+#include "Flags.h"
+
+void Flags::SetLazy(const bool enabled)
+{
+    Resolve();
+    lazy = enabled;
+}
+
+void Flags::Materialize()
+{
+    const LazyRecord* records[] = { pendingArithmetic ? &arithmetic : nullptr, pendingResult ? &result : nullptr };
+    Discard();
+
+    for (const LazyRecord* record : records)
+    {
+        if (record == nullptr) continue;
+
+        switch (record->bits)
+        {
+        case 8: Evaluate<uint8_t>(*record); break;
+        case 16: Evaluate<uint16_t>(*record); break;
+        default: Evaluate<uint32_t>(*record); break;
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 class Board;
@@ -22,6 +23,121 @@ public:
 
     template<typename T>
     void Mov(T value, size_t bits = sizeof(T) * 8)
+    {
+        if (lazy) Record(LazyMov, value, 0, bits);
+        else MovNow(value, bits);
+    }
+
+    template<typename T>
+    void Add(T rdValue, T rsValue, size_t bits = sizeof(T) * 8)
+    {
+        if (lazy) Record(LazyAdd, rdValue, rsValue, bits);
+        else AddNow(rdValue, rsValue, bits);
+    }
+
+    template<typename T>
+    void Sub(T rdValue, T rsValue, size_t bits = sizeof(T) * 8)
+    {
+        if (lazy) Record(LazySub, rdValue, rsValue, bits);
+        else SubNow(rdValue, rsValue, bits);
+    }
+
+    template<typename T>
+    void Inc(T value, size_t inc, size_t bits = sizeof(T) * 8)
+    {
+        if (lazy) Record(LazyInc, value, inc, bits);
+        else IncNow(value, inc, bits);
+    }
+
+    template<typename T>
+    void Dec(T value, size_t dec, size_t bits = sizeof(T) * 8)
+    {
+        if (lazy) Record(LazyDec, value, dec, bits);
+        else DecNow(value, dec, bits);
+    }
+
+    // In lazy mode the ALU ops above only record their operands, and the
+    // flags they would have set are worked out here. Anything that reads or
+    // partially writes the flags (Bcc, SUBX, bit loads/stores, interrupt
+    // entry, generated code...) has to call this first.
+    void Resolve()
+    {
+        if (pendingArithmetic || pendingResult)
+        {
+            Materialize();
+        }
+    }
+
+    // Drops whatever is pending, for LDC and RTE which replace the ccr whole.
+    void Discard()
+    {
+        pendingArithmetic = false;
+        pendingResult = false;
+    }
+
+    void SetLazy(bool enabled);
+    bool Lazy() const { return lazy; }
+
+    static uint32_t NegativeMask(size_t bits)
+    {
+        return 1 << (bits - 1);   
+    }
+    
+private:
+    enum LazyOperation : uint8_t
+    {
+        LazyMov,
+        LazyAdd,
+        LazySub,
+        LazyInc,
+        LazyDec
+    };
+
+    struct LazyRecord
+    {
+        LazyOperation operation;
+        uint8_t bits;
+        uint32_t first;
+        uint32_t second;
+    };
+
+    // ADD/SUB set every flag, the rest only N, Z and V, so the last ADD/SUB
+    // is kept around for C and H until something replaces it.
+    void Record(const LazyOperation operation, const uint32_t first, const uint32_t second, const size_t bits)
+    {
+        if (operation == LazyAdd || operation == LazySub)
+        {
+            arithmetic = { operation, static_cast<uint8_t>(bits), first, second };
+            pendingArithmetic = true;
+            pendingResult = false;
+        }
+        else
+        {
+            result = { operation, static_cast<uint8_t>(bits), first, second };
+            pendingResult = true;
+        }
+    }
+
+    void Materialize();
+
+    template<typename T>
+    void Evaluate(const LazyRecord& record)
+    {
+        const T first = static_cast<T>(record.first);
+        const T second = static_cast<T>(record.second);
+
+        switch (record.operation)
+        {
+        case LazyMov: MovNow(first); break;
+        case LazyAdd: AddNow(first, second); break;
+        case LazySub: SubNow(first, second); break;
+        case LazyInc: IncNow(first, record.second); break;
+        case LazyDec: DecNow(first, record.second); break;
+        }
+    }
+
+    template<typename T>
+    void MovNow(T value, size_t bits = sizeof(T) * 8)
     {
         const uint32_t negativeMask = NegativeMask(bits);
 
@@ -31,7 +147,7 @@ public:
     }
 
     template<typename T>
-    void Add(T rdValue, T rsValue, size_t bits = sizeof(T) * 8)
+    void AddNow(T rdValue, T rsValue, size_t bits = sizeof(T) * 8)
     {
         const uint32_t negativeMask = NegativeMask(bits);
         const uint32_t maxValue = (1 << bits) - 1;
@@ -45,7 +161,7 @@ public:
     }
     
     template<typename T>
-    void Sub(T rdValue, T rsValue, size_t bits = sizeof(T) * 8)
+    void SubNow(T rdValue, T rsValue, size_t bits = sizeof(T) * 8)
     {
         const uint32_t negativeMask = NegativeMask(bits);
         const uint32_t result = rdValue - rsValue;
@@ -58,7 +174,7 @@ public:
     }
 
     template<typename T>
-    void Inc(T value, size_t inc, size_t bits = sizeof(T) * 8)
+    void IncNow(T value, size_t inc, size_t bits = sizeof(T) * 8)
     {
         const uint32_t negativeMask = NegativeMask(bits);
         const uint32_t result = value + inc;
@@ -69,7 +185,7 @@ public:
     }
 
     template<typename T>
-    void Dec(T value, size_t dec, size_t bits = sizeof(T) * 8)
+    void DecNow(T value, size_t dec, size_t bits = sizeof(T) * 8)
     {
         const uint32_t negativeMask = NegativeMask(bits);
         const uint32_t result = value - dec;
@@ -78,10 +194,10 @@ public:
         zero = result == 0;
         overflow = value == negativeMask;
     }
-    
-    static uint32_t NegativeMask(size_t bits)
-    {
-        return 1 << (bits - 1);   
-    }
-    
+
+    bool lazy = false;
+    bool pendingArithmetic = false;
+    bool pendingResult = false;
+    LazyRecord arithmetic{};
+    LazyRecord result{};
 };
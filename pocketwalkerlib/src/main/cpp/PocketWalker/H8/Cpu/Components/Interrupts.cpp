@@ -1,3 +1,4 @@
+#include <bit>
 #include <print>
 #include "Interrupts.h"
 
@@ -5,46 +6,57 @@
 
 void Interrupts::Update(Cpu* cpu)
 {
-    if (enable1 & InterruptFlags::ENABLE_IRQ0 && flag1 & InterruptFlags::FLAG_IRQ0)
+    if (pending == 0)
     {
-        Interrupt(cpu, cpu->vectorTable->irq0);
+        return;
     }
-    else if (enable1 & InterruptFlags::ENABLE_IRQ1 && flag1 & InterruptFlags::FLAG_IRQ1)
-    {
-        Interrupt(cpu, cpu->vectorTable->irq1);
-    }
-    else if (enable1 & InterruptFlags::ENABLE_RTC && rtcFlag & InterruptFlags::FLAG_QUARTER_SECOND)
-    {
-        Interrupt(cpu, cpu->vectorTable->quarterSecond);
-    }
-    else if (enable1 & InterruptFlags::ENABLE_RTC && rtcFlag & InterruptFlags::FLAG_HALF_SECOND)
-    {
-        Interrupt(cpu, cpu->vectorTable->halfSecond);
-    }
-    else if (enable1 & InterruptFlags::ENABLE_RTC && rtcFlag & InterruptFlags::FLAG_SECOND)
-    {
-        Interrupt(cpu, cpu->vectorTable->second);
-    }
-    else if (enable1 & InterruptFlags::ENABLE_RTC && rtcFlag & InterruptFlags::FLAG_MINUTE)
-    {
-        Interrupt(cpu, cpu->vectorTable->minute);
-    }
-    else if (enable1 & InterruptFlags::ENABLE_RTC && rtcFlag & InterruptFlags::FLAG_HOUR)
-    {
-        Interrupt(cpu, cpu->vectorTable->hour);
-    }
-    else if (enable2 & InterruptFlags::ENABLE_TIMER_B1 && flag2 & InterruptFlags::FLAG_TIMER_B1)
+
+    switch (static_cast<InterruptFlags::Source>(std::countl_zero(pending)))
     {
-        Interrupt(cpu, cpu->vectorTable->timerB1);
+    case InterruptFlags::SOURCE_IRQ0: Interrupt(cpu, cpu->vectorTable->irq0); break;
+    case InterruptFlags::SOURCE_IRQ1: Interrupt(cpu, cpu->vectorTable->irq1); break;
+    case InterruptFlags::SOURCE_QUARTER_SECOND: Interrupt(cpu, cpu->vectorTable->quarterSecond); break;
+    case InterruptFlags::SOURCE_HALF_SECOND: Interrupt(cpu, cpu->vectorTable->halfSecond); break;
+    case InterruptFlags::SOURCE_SECOND: Interrupt(cpu, cpu->vectorTable->second); break;
+    case InterruptFlags::SOURCE_MINUTE: Interrupt(cpu, cpu->vectorTable->minute); break;
+    case InterruptFlags::SOURCE_HOUR: Interrupt(cpu, cpu->vectorTable->hour); break;
+    case InterruptFlags::SOURCE_TIMER_B1: Interrupt(cpu, cpu->vectorTable->timerB1); break;
+    case InterruptFlags::SOURCE_TIMER_W: Interrupt(cpu, cpu->vectorTable->timerW); break;
     }
-    else if (enableTimerW & InterruptFlags::ENABLE_TIMER_W_REGISTER_A && flagTimerW & InterruptFlags::FLAG_TIMER_W_REGISTER_A)
+}
+
+void Interrupts::UpdatePending()
+{
+    using namespace InterruptFlags;
+
+    const uint8_t enabled1 = enable1;
+    const uint8_t flagged1 = flag1;
+    const uint8_t rtc = rtcFlag;
+
+    uint32_t mask = 0;
+
+    if (enabled1 & ENABLE_IRQ0 && flagged1 & FLAG_IRQ0) mask |= Bit(SOURCE_IRQ0);
+    if (enabled1 & ENABLE_IRQ1 && flagged1 & FLAG_IRQ1) mask |= Bit(SOURCE_IRQ1);
+
+    if (enabled1 & ENABLE_RTC)
     {
-        Interrupt(cpu, cpu->vectorTable->timerW);
+        if (rtc & FLAG_QUARTER_SECOND) mask |= Bit(SOURCE_QUARTER_SECOND);
+        if (rtc & FLAG_HALF_SECOND) mask |= Bit(SOURCE_HALF_SECOND);
+        if (rtc & FLAG_SECOND) mask |= Bit(SOURCE_SECOND);
+        if (rtc & FLAG_MINUTE) mask |= Bit(SOURCE_MINUTE);
+        if (rtc & FLAG_HOUR) mask |= Bit(SOURCE_HOUR);
     }
+
+    if (enable2 & ENABLE_TIMER_B1 && flag2 & FLAG_TIMER_B1) mask |= Bit(SOURCE_TIMER_B1);
+    if (enableTimerW & ENABLE_TIMER_W_REGISTER_A && flagTimerW & FLAG_TIMER_W_REGISTER_A) mask |= Bit(SOURCE_TIMER_W);
+
+    pending = mask;
 }
 
 void Interrupts::Interrupt(Cpu* cpu, uint16_t address)
 {
+    cpu->flags->Resolve();
+
     savedAddress = cpu->registers->pc;
     savedFlags = cpu->flags->ccr;
 
@@ -68,6 +68,20 @@ namespace InterruptFlags
         FLAG_TIMER_W_REGISTER_B = 1 << 1,
         FLAG_TIMER_W_REGISTER_A = 1 << 0,
     };
+
+    // Dispatchable sources, highest priority first.
+    enum Source : uint8_t
+    {
+        SOURCE_IRQ0,
+        SOURCE_IRQ1,
+        SOURCE_QUARTER_SECOND,
+        SOURCE_HALF_SECOND,
+        SOURCE_SECOND,
+        SOURCE_MINUTE,
+        SOURCE_HOUR,
+        SOURCE_TIMER_B1,
+        SOURCE_TIMER_W
+    };
 }
 
 
@@ -83,12 +97,25 @@ public:
         enableTimerW(ram->CreateAccessor<uint8_t>(TIMER_W_ENABLE_ADDR)),
         flagTimerW(ram->CreateAccessor<uint8_t>(TIMER_W_FLAG_ADDR))
     {
-        
+        for (const uint16_t address : { IENR1_ADDR, IENR2_ADDR, IRR1_ADDR, IRR2_ADDR, RTC_ADDR, TIMER_W_ENABLE_ADDR, TIMER_W_FLAG_ADDR })
+        {
+            ram->OnWrite(address, [this](uint32_t)
+            {
+                UpdatePending();
+            });
+        }
     }
 
+    // Takes the highest priority pending source, if any.
     void Update(Cpu* cpu);
     void Interrupt(Cpu* cpu, uint16_t address);
 
+    // Rebuilds the pending mask from the enable and flag registers. Runs on
+    // every write to them, call it after changing them behind Memory's back.
+    void UpdatePending();
+
+    bool Pending() const { return pending != 0; }
+
     uint8_t savedFlags;
     uint16_t savedAddress;
     
@@ -102,5 +129,11 @@ public:
     MemoryAccessor<uint8_t> flagTimerW;
 
 private:
+    static constexpr uint32_t Bit(const InterruptFlags::Source source) { return 0x80000000u >> source; }
+
+    // One bit per enabled and flagged source, IRQ0 in the top bit so the
+    // leading zero count is the source to take.
+    uint32_t pending = 0;
+
     Memory* ram;
 };
@@ -1,30 +1,31 @@
 #include "Opcode.h"
 
+#include <cstring>
+
 #include "../../Board/Board.h"
 
-Opcode::Opcode(Memory* ram) : ram(ram), currentAddress(0)
+Opcode::Opcode(Memory* ram) : ram(ram), currentAddress(0), validFlags(0)
 {
-    for (bool& validFlag : validFlags)
-    {
-        validFlag = false;
-    }
 }
 
 void Opcode::Update(const uint16_t address)
 {
     currentAddress = address;
-    
-    for (bool& validFlag : validFlags)
-    {
-        validFlag = false;
-    }
+    validFlags = 0;
+}
+
+void Opcode::Load(const uint16_t address, const uint8_t* bytes)
+{
+    currentAddress = address;
+    std::memcpy(cacheBytes, bytes, sizeof(cacheBytes));
+    validFlags = 0xFF;
 }
 
 uint8_t Opcode::get_byte(int index) const
 {
-    if (!validFlags[index]) {
+    if (!(validFlags >> index & 1)) {
         cacheBytes[index] = ram->ReadByte(currentAddress + index);
-        validFlags[index] = true;
+        validFlags |= 1 << index;
     }
     return cacheBytes[index];
 }
@@ -9,6 +9,9 @@ public:
     Opcode(Memory* ram);
 
     void Update(uint16_t address);
+    // Takes all eight bytes at once, e.g. from the decode cache, without
+    // going back through memory.
+    void Load(uint16_t address, const uint8_t* bytes);
     
     uint8_t a() const;
     uint8_t b() const;
@@ -46,7 +49,7 @@ private:
     uint16_t currentAddress;
     
     mutable uint8_t cacheBytes[8];
-    mutable bool validFlags[8];
+    mutable uint8_t validFlags;
     
     uint8_t get_byte(int index) const;
 };
\ No newline at end of file
@@ -25,11 +25,26 @@ public:
         sp = Register32(7);
     }
 
-    uint8_t* Register8(const uint8_t control) const;
+    // Defined here so the instruction handlers can inline them.
+    uint8_t* Register8(const uint8_t control) const
+    {
+        const uint8_t regIndex = control & 0b111;
+        const uint8_t offset = ~(control >> 3) & 1;
+        return &this->buffer[regIndex * 4 + offset];
+    }
 
-    uint16_t* Register16(const uint8_t control) const;
+    uint16_t* Register16(const uint8_t control) const
+    {
+        const uint8_t regIndex = control & 0b111;
+        const uint8_t offset = control >> 3 & 1;
+        return &reinterpret_cast<uint16_t*>(this->buffer)[regIndex * 2 + offset];
+    }
 
-    uint32_t* Register32(const uint8_t control) const;
+    uint32_t* Register32(const uint8_t control) const
+    {
+        const uint8_t regIndex = control & 0b111;
+        return &reinterpret_cast<uint32_t*>(this->buffer)[regIndex];
+    }
 
     void PushStack() const;
     uint16_t PopStack() const;
@@ -1,30 +1,56 @@
 #include "Cpu.h"
 #include <print>
+#include <utility>
+
+#include "../../Utilities/StateSerializer.h"
 
 size_t Cpu::Step()
 {
-    size_t cycleCount = 1;
-    
     if (registers->pc == 0x0000)
     {
         throw std::runtime_error("Program finished execution.");
     }
 
-    opcodes->Update(registers->pc);
+    // Hooked and odd addresses always go through the interpreter, blocks
+    // never contain either.
+    if (blockCache != nullptr && !sleeping && !(registers->pc & 1) && !HasAddressHandler(registers->pc))
+    {
+        return blockCache->Execute();
+    }
+
+    return StepInstruction();
+}
+
+size_t Cpu::StepInstruction()
+{
+    size_t cycleCount = 1;
+
+    Instruction* instruction = decodeCache->Fetch(registers->pc, opcodes);
     
     PCHandlerResult handlerResult = Continue;
-    if (addressHandlers.contains(registers->pc))
+    if (HasAddressHandler(registers->pc))
     {
-        handlerResult = addressHandlers[registers->pc](this);
+        for (const Hook& hook : hooks)
+        {
+            if (hook.address == registers->pc && hook.handler)
+            {
+                // A copy, the handler may add or remove hooks.
+                const PCHandler handler = hook.handler;
+                handlerResult = handler(this);
+                break;
+            }
+        }
     }
     
     if (!sleeping && handlerResult != SkipInstruction)
     {
-        const Instruction* instruction = instructions->Execute(this);
+        instructions->Execute(this, instruction);
         cycleCount = instruction->cycles;
         instructionCount++;
     }
 
+    cycleCount += std::exchange(handlerCycles, 0);
+
     return cycleCount;
 }
 
@@ -33,7 +59,83 @@ void Cpu::UpdateInterrupts()
     interrupts->Update(this);
 }
 
-void Cpu::OnAddress(const uint16_t address, const PCHandler& handler)
+HookId Cpu::OnAddress(const uint16_t address, const PCHandler& handler)
 {
-    addressHandlers[address] = handler;
+    HookId id = static_cast<HookId>(hooks.size());
+    for (HookId index = 0; index < hooks.size(); index++)
+    {
+        if (hooks[index].handler && hooks[index].address == address)
+        {
+            id = index;
+            break;
+        }
+
+        if (!hooks[index].handler && id == hooks.size())
+        {
+            id = index;
+        }
+    }
+
+    if (id == hooks.size())
+    {
+        hooks.push_back({});
+    }
+
+    hooks[id] = { address, handler };
+    hookBits[address >> 6] |= 1ull << (address & 63);
+
+    // Existing blocks may run straight through the new hook.
+    if (blockCache != nullptr)
+    {
+        blockCache->Invalidate(address);
+    }
+
+    return id;
+}
+
+void Cpu::RemoveAddressHandler(const HookId id)
+{
+    Hook& hook = hooks[id];
+    if (!hook.handler)
+    {
+        return;
+    }
+
+    // Blocks ending at the hook stay valid, they just stop earlier than they
+    // have to.
+    hook.handler = nullptr;
+    hookBits[hook.address >> 6] &= ~(1ull << (hook.address & 63));
+}
+
+void Cpu::SaveState(StateWriter& writer) const
+{
+    flags->Resolve();
+
+    writer.WriteBytes(registers->buffer, 32);
+    writer.Write(registers->pc);
+    writer.Write(flags->ccr);
+    writer.Write(sleeping);
+    writer.Write<uint64_t>(instructionCount);
+
+    writer.Write(interrupts->savedFlags);
+    writer.Write(interrupts->savedAddress);
+}
+
+void Cpu::LoadState(StateReader& reader)
+{
+    reader.ReadBytes(registers->buffer, 32);
+    reader.Read(registers->pc);
+    flags->Discard();
+    reader.Read(flags->ccr);
+    reader.Read(sleeping);
+    instructionCount = reader.Read<uint64_t>();
+
+    reader.Read(interrupts->savedFlags);
+    reader.Read(interrupts->savedAddress);
+
+    decodeCache->Flush();
+    if (blockCache != nullptr)
+    {
+        blockCache->Flush();
+    }
 }
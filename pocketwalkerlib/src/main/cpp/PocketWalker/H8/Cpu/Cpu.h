@@ -1,16 +1,23 @@
 #pragma once
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <vector>
 
 #include "Components/Opcode.h"
 #include "Components/Registers.h"
 #include "Components/Flags.h"
 #include "Components/VectorTable.h"
 #include "Components/Interrupts.h"
+#include "Components/DecodeCache.h"
+#include "Components/BlockCache.h"
 #include "Instructions/InstructionTable.h"
 
 class Interrupts;
 class Memory;
 class Board;
+class StateWriter;
+class StateReader;
 
 class Opcode;
 class Registers;
@@ -23,30 +30,78 @@ enum PCHandlerResult : uint8_t
 };
 
 using PCHandler = std::function<PCHandlerResult(Cpu*)>;
+using HookId = uint16_t;
+
+enum class ExecutionMode : uint8_t
+{
+    // One instruction per step.
+    Interpreter,
+    // A whole basic block per step, hooks and interrupts only between blocks.
+    // Condition codes are only worked out when something reads them, see
+    // Flags::SetLazy. The same goes for the modes below.
+    BlockCache,
+    // BlockCache with hot blocks compiled to native code. x86-64 only, other
+    // hosts run plain blocks.
+    Recompiler,
+    // Recompiler, checking every compiled block or op against the
+    // interpreter as it runs. Throws on the first mismatch.
+    RecompilerVerify,
+    // BlockCache, with every cached block first run on the side by the plain
+    // interpreter and the two compared. Throws on the first mismatch. Memory
+    // written from another thread meanwhile skips its handlers and shows up
+    // as a mismatch, so host input has to reach memory on the emulator
+    // thread, as Buttons does.
+    BlockCacheVerify
+};
 
 class Cpu
 {
 public:
-    Cpu(Memory* ram) : ram(ram)
+    Cpu(Memory* ram, const ExecutionMode executionMode = ExecutionMode::Interpreter) : ram(ram), executionMode(executionMode)
     {
         instructions = new InstructionTable();
+        decodeCache = new DecodeCache(ram, instructions);
         opcodes = new Opcode(ram);
         registers = new Registers(ram);
         vectorTable = new VectorTable(ram);
         interrupts = new Interrupts(ram);
         flags = new Flags();
+        flags->SetLazy(executionMode != ExecutionMode::Interpreter);
+        blockCache = executionMode != ExecutionMode::Interpreter ? new BlockCache(this) : nullptr;
 
         registers->pc = vectorTable->reset;
     }
 
     size_t Step();
     void UpdateInterrupts();
-    void OnAddress(uint16_t address, const PCHandler& handler);
+
+    // Runs handler every time pc reaches address, before the instruction
+    // there. Replaces any handler already at address and keeps its id. Safe
+    // to call while running, even from a handler, only the blocks through
+    // address are dropped.
+    HookId OnAddress(uint16_t address, const PCHandler& handler);
+    void RemoveAddressHandler(HookId id);
+
+    bool HasAddressHandler(const uint16_t address) const
+    {
+        return hookBits[address >> 6] >> (address & 63) & 1;
+    }
+
+    // For address handlers that do a whole routine's work natively, charged
+    // on top of the step the handler ran in.
+    void AddCycles(const size_t cycles) { handlerCycles += cycles; }
+
+    // Registers, ccr, sleep and interrupt context. Loading also drops every
+    // cached decode and block, since memory is restored behind their back.
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
 
     Memory* ram;
     
     Opcode* opcodes;
     InstructionTable* instructions;
+    DecodeCache* decodeCache;
+    BlockCache* blockCache;
     VectorTable* vectorTable;
     Interrupts* interrupts;
     Registers* registers;
@@ -55,8 +110,23 @@ public:
     size_t instructionCount;
     bool sleeping = false;
 
+    const ExecutionMode executionMode;
+
     static constexpr uint32_t TICKS = 3686400;
 
 private:
-    std::map<uint16_t, PCHandler> addressHandlers;
+    size_t StepInstruction();
+
+    struct Hook
+    {
+        uint16_t address;
+        // Empty for a removed hook, its slot is reused.
+        PCHandler handler;
+    };
+
+    // Indexed by HookId. Only looked at once the bitmap says there is a hook,
+    // which almost no instruction has.
+    std::vector<Hook> hooks;
+    std::array<uint64_t, 0x10000 / 64> hookBits{};
+    size_t handlerCycles = 0;
 };
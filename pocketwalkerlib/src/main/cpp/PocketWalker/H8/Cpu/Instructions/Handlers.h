@@ -0,0 +1,375 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#include "../Cpu.h"
+#include "../../Memory/Memory.h"
+
+// Handler templates for the instruction families that only differ by operand
+// size, addressing mode or operation. Every instantiation is a plain
+// void(Cpu*) function the instruction table points at directly, with the
+// operand access and flag update resolved at compile time.
+namespace Handlers
+{
+    template<typename T>
+    T* Register(const Cpu* cpu, const uint8_t control)
+    {
+        if constexpr (sizeof(T) == 1) return cpu->registers->Register8(control);
+        else if constexpr (sizeof(T) == 2) return cpu->registers->Register16(control);
+        else return cpu->registers->Register32(control);
+    }
+
+    template<typename T>
+    T Read(const Cpu* cpu, const uint16_t address)
+    {
+        if constexpr (sizeof(T) == 1) return cpu->ram->ReadByte(address);
+        else if constexpr (sizeof(T) == 2) return cpu->ram->ReadShort(address);
+        else return cpu->ram->ReadInt(address);
+    }
+
+    template<typename T>
+    void Write(const Cpu* cpu, const uint16_t address, const T value)
+    {
+        if constexpr (sizeof(T) == 1) cpu->ram->WriteByte(address, value);
+        else if constexpr (sizeof(T) == 2) cpu->ram->WriteShort(address, value);
+        else cpu->ram->WriteInt(address, value);
+    }
+
+    enum Operation : uint8_t
+    {
+        Mov,
+        Add,
+        Sub,
+        Cmp,
+        Or,
+        Xor,
+        And
+    };
+
+    template<typename T, Operation operation>
+    void Apply(const Cpu* cpu, T* rd, const T value)
+    {
+        if constexpr (operation == Mov)
+        {
+            *rd = value;
+            cpu->flags->Mov(*rd);
+        }
+        else if constexpr (operation == Add)
+        {
+            cpu->flags->Add(*rd, value);
+            *rd += value;
+        }
+        else if constexpr (operation == Sub)
+        {
+            cpu->flags->Sub(*rd, value);
+            *rd -= value;
+        }
+        else if constexpr (operation == Cmp)
+        {
+            cpu->flags->Sub(*rd, value);
+        }
+        else
+        {
+            if constexpr (operation == Or) *rd |= value;
+            else if constexpr (operation == Xor) *rd ^= value;
+            else *rd &= value;
+
+            cpu->flags->Mov(*rd);
+        }
+    }
+
+    // op Rs, Rd with the registers in bH/bL, or in dH/dL behind a 01xx prefix.
+    template<typename T, Operation operation, bool prefixed = false>
+    void RegisterOperation(Cpu* cpu)
+    {
+        const uint8_t source = prefixed ? cpu->opcodes->dH() : cpu->opcodes->bH();
+        const uint8_t destination = prefixed ? cpu->opcodes->dL() : cpu->opcodes->bL();
+
+        Apply<T, operation>(cpu, Register<T>(cpu, destination), *Register<T>(cpu, source));
+    }
+
+    // op #xx, Rd. Byte immediates are the second byte with Rd in aL, word and
+    // long immediates follow the register byte.
+    template<typename T, Operation operation>
+    void ImmediateOperation(Cpu* cpu)
+    {
+        if constexpr (sizeof(T) == 1)
+        {
+            Apply<T, operation>(cpu, Register<T>(cpu, cpu->opcodes->aL()), cpu->opcodes->b());
+        }
+        else if constexpr (sizeof(T) == 2)
+        {
+            Apply<T, operation>(cpu, Register<T>(cpu, cpu->opcodes->bL()), cpu->opcodes->cd());
+        }
+        else
+        {
+            const uint32_t imm = cpu->opcodes->cd() << 16 | cpu->opcodes->ef();
+            Apply<T, operation>(cpu, Register<T>(cpu, cpu->opcodes->bL()), imm);
+        }
+    }
+
+    enum AddressingMode : uint8_t
+    {
+        Absolute8,     // @aa:8, byte only
+        Absolute16,    // @aa:16
+        Absolute24,    // @aa:24, @aa:32 for MOV.L
+        Indirect,      // @ERn
+        PostIncrement, // @ERn+
+        PreDecrement,  // @-ERn
+        Displacement16 // @(d:16,ERn)
+    };
+
+    // MOV.L carries a 01 00 prefix, which pushes every field two bytes out.
+    template<typename T, AddressingMode mode>
+    uint8_t DataRegister(const Cpu* cpu)
+    {
+        if constexpr (mode == Absolute8) return cpu->opcodes->aL();
+        else if constexpr (sizeof(T) == 4) return cpu->opcodes->dL();
+        else return cpu->opcodes->bL();
+    }
+
+    template<typename T>
+    uint32_t* AddressRegister(const Cpu* cpu)
+    {
+        return Register<uint32_t>(cpu, sizeof(T) == 4 ? cpu->opcodes->dH() : cpu->opcodes->bH());
+    }
+
+    // Pre-decrement is applied here, post-increment is left to the caller
+    // since it has to happen after the access.
+    template<typename T, AddressingMode mode>
+    uint32_t Address(const Cpu* cpu)
+    {
+        constexpr bool prefixed = sizeof(T) == 4;
+
+        if constexpr (mode == Absolute8)
+        {
+            return cpu->opcodes->b() | 0xFF00;
+        }
+        else if constexpr (mode == Absolute16)
+        {
+            return prefixed ? cpu->opcodes->ef() : cpu->opcodes->cd();
+        }
+        else if constexpr (mode == Absolute24)
+        {
+            return prefixed ? cpu->opcodes->ef() << 16 | cpu->opcodes->gh() : cpu->opcodes->cd() << 16 | cpu->opcodes->ef();
+        }
+        else if constexpr (mode == PreDecrement)
+        {
+            uint32_t* ern = AddressRegister<T>(cpu);
+            *ern -= sizeof(T);
+            return *ern;
+        }
+        else if constexpr (mode == Displacement16)
+        {
+            const int16_t disp = prefixed ? cpu->opcodes->ef() : cpu->opcodes->cd();
+            return *AddressRegister<T>(cpu) + disp;
+        }
+        else
+        {
+            return *AddressRegister<T>(cpu);
+        }
+    }
+
+    // MOV @<ea>, Rd
+    template<typename T, AddressingMode mode>
+    void Load(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, DataRegister<T, mode>(cpu));
+        *rd = Read<T>(cpu, Address<T, mode>(cpu));
+
+        if constexpr (mode == PostIncrement)
+        {
+            *AddressRegister<T>(cpu) += sizeof(T);
+        }
+
+        cpu->flags->Mov(*rd);
+    }
+
+    // MOV Rs, @<ea>
+    template<typename T, AddressingMode mode>
+    void Store(Cpu* cpu)
+    {
+        const T* rs = Register<T>(cpu, DataRegister<T, mode>(cpu));
+        const uint32_t address = Address<T, mode>(cpu);
+
+        Write<T>(cpu, address, *rs);
+
+        cpu->flags->Mov(*rs);
+    }
+
+    // Bcc condition codes, in the order of the low opcode nibble.
+    enum Condition : uint8_t
+    {
+        Always,
+        Never,
+        High,
+        LowOrSame,
+        CarryClear,
+        CarrySet,
+        NotEqual,
+        Equal,
+        OverflowClear,
+        OverflowSet,
+        Plus,
+        Minus,
+        GreaterOrEqual,
+        Less,
+        Greater,
+        LessOrEqual
+    };
+
+    template<Condition condition>
+    bool Test(const Flags* flags)
+    {
+        if constexpr (condition == Always) return true;
+        else if constexpr (condition == Never) return false;
+        else if constexpr (condition == High) return !(flags->carry || flags->zero);
+        else if constexpr (condition == LowOrSame) return flags->carry || flags->zero;
+        else if constexpr (condition == CarryClear) return !flags->carry;
+        else if constexpr (condition == CarrySet) return flags->carry;
+        else if constexpr (condition == NotEqual) return !flags->zero;
+        else if constexpr (condition == Equal) return flags->zero;
+        else if constexpr (condition == OverflowClear) return !flags->overflow;
+        else if constexpr (condition == OverflowSet) return flags->overflow;
+        else if constexpr (condition == Plus) return !flags->negative;
+        else if constexpr (condition == Minus) return flags->negative;
+        else if constexpr (condition == GreaterOrEqual) return flags->negative == flags->overflow;
+        else if constexpr (condition == Less) return flags->negative != flags->overflow;
+        else if constexpr (condition == Greater) return !(flags->zero || (flags->negative != flags->overflow));
+        else return flags->zero || (flags->negative != flags->overflow);
+    }
+
+    // Bcc d:8 (disp in b) and Bcc d:16 (disp in cd).
+    template<typename Displacement, Condition condition>
+    void Branch(Cpu* cpu)
+    {
+        cpu->flags->Resolve();
+        if (Test<condition>(cpu->flags))
+        {
+            const Displacement disp = static_cast<Displacement>(sizeof(Displacement) == 1 ? cpu->opcodes->b() : cpu->opcodes->cd());
+            cpu->registers->pc += disp;
+        }
+    }
+
+    template<typename T, size_t amount>
+    void Increment(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        cpu->flags->Inc(*rd, amount);
+
+        *rd += amount;
+    }
+
+    template<typename T, size_t amount>
+    void Decrement(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        cpu->flags->Dec(*rd, amount);
+
+        *rd -= amount;
+    }
+
+    // ADDS/SUBS, which leave the flags alone.
+    template<int32_t amount>
+    void AddAddress(Cpu* cpu)
+    {
+        uint32_t* erd = Register<uint32_t>(cpu, cpu->opcodes->bL());
+        *erd += amount;
+    }
+
+    template<typename T>
+    void ShiftLeft(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        cpu->flags->Resolve();
+        cpu->flags->carry = *rd & Flags::NegativeMask(sizeof(T) * 8);
+
+        *rd <<= 1;
+
+        cpu->flags->Mov(*rd);
+    }
+
+    template<typename T>
+    void ShiftRight(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        cpu->flags->Resolve();
+        cpu->flags->carry = *rd & 1;
+
+        *rd >>= 1;
+
+        cpu->flags->Mov(*rd);
+    }
+
+    template<typename T>
+    void ShiftRightArithmetic(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        cpu->flags->Resolve();
+        cpu->flags->carry = *rd & 1;
+
+        *rd = (*rd >> 1) | (*rd & Flags::NegativeMask(sizeof(T) * 8));
+
+        cpu->flags->Mov(*rd);
+    }
+
+    template<typename T>
+    void RotateLeft(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        const uint8_t msb = (*rd >> (sizeof(T) * 8 - 1)) & 1;
+
+        *rd = (*rd << 1) | msb;
+
+        cpu->flags->Resolve();
+        cpu->flags->carry = msb;
+        cpu->flags->Mov(*rd);
+    }
+
+    template<typename T>
+    void RotateRight(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        const uint8_t lsb = *rd & 1;
+
+        *rd = (*rd >> 1) | (lsb << (sizeof(T) * 8 - 1));
+
+        cpu->flags->Resolve();
+        cpu->flags->carry = lsb;
+        cpu->flags->Mov(*rd);
+    }
+
+    template<typename T>
+    void Negate(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        cpu->flags->Sub(static_cast<T>(0), *rd);
+
+        if (*rd != Flags::NegativeMask(sizeof(T) * 8))
+        {
+            *rd = -*rd;
+        }
+    }
+
+    template<typename T>
+    void ZeroExtend(Cpu* cpu)
+    {
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        *rd &= static_cast<T>(-1) >> (sizeof(T) * 4);
+
+        cpu->flags->Mov(*rd);
+    }
+
+    template<typename T>
+    void SignExtend(Cpu* cpu)
+    {
+        using Half = std::conditional_t<sizeof(T) == 2, int8_t, int16_t>;
+        using Signed = std::conditional_t<sizeof(T) == 2, int16_t, int32_t>;
+
+        T* rd = Register<T>(cpu, cpu->opcodes->bL());
+        const Half firstPart = static_cast<Half>(*rd & (static_cast<T>(-1) >> (sizeof(T) * 4)));
+        *rd = static_cast<Signed>(firstPart);
+
+        cpu->flags->Mov(*rd);
+    }
+}
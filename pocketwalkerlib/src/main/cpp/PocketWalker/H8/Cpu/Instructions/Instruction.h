@@ -1,11 +1,12 @@
 #pragma once
-#include <functional>
 #include <string>
 
 class InstructionContainer;
 class Cpu;
 
-using InstructionExecute = std::function<void(Cpu*)>;
+// Plain function pointers, either a one-off lambda or an instantiation of one
+// of the templates in Handlers.h.
+using InstructionExecute = void (*)(Cpu*);
 
 struct Instruction
 {
@@ -16,7 +17,11 @@ struct Instruction
     InstructionExecute postExecute;
     InstructionContainer* parentContainer;
 
+    // Set on the dispatch entries of prefixed opcodes (0x01xx, 0x7Cxx-0x7Fxx)
+    // whose meaning depends on the next byte and nibble. Indexed by cd >> 4.
+    Instruction* const* extension = nullptr;
+
     Instruction() = default;
-    Instruction(const std::string& name, const int bytes, const int cycles, const InstructionExecute& execute, const InstructionExecute& postExecute = nullptr, InstructionContainer* parentContainer = nullptr)
+    Instruction(const std::string& name, const int bytes, const int cycles, const InstructionExecute execute, const InstructionExecute postExecute = nullptr, InstructionContainer* parentContainer = nullptr)
         : name(name), bytes(bytes), cycles(cycles), execute(execute), postExecute(postExecute), parentContainer(parentContainer) { }
 };
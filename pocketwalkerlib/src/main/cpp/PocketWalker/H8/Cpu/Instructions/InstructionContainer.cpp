@@ -1,44 +1,24 @@
 #include "InstructionContainer.h"
 
-#include <format>
-#include <stdexcept>
-#include <print>
-#include <queue>
+#include "../Components/Opcode.h"
 
-#include "../Cpu.h"
-
-Instruction* InstructionContainer::Execute(Cpu* cpu)
+Instruction* InstructionContainer::Resolve(Opcode* opcode)
 {
-    const uint32_t firstValue = firstPredicate(cpu->opcodes);
-    const uint32_t secondValue = secondPredicate(cpu->opcodes);
+    const uint32_t firstValue = firstPredicate(opcode);
+    const uint32_t secondValue = secondPredicate(opcode);
 
     Instruction* instruction = GetInstruction(firstValue, secondValue);
     if (instruction == nullptr) instruction = GetPatternInstruction(firstValue, secondValue);
     if (instruction == nullptr)
     {
-        throw std::runtime_error(std::format("Instruction at 0x{:02X} with values 0x{:02X} and 0x{:02X} does not exist in table {}", cpu->registers->pc, firstValue, secondValue, tableName));
+        return nullptr;
     }
 
     if (instruction->parentContainer != nullptr)
     {
-        return instruction->parentContainer->Execute(cpu);
+        return instruction->parentContainer->Resolve(opcode);
     }
 
-    const uint16_t preExecuteLocation = cpu->registers->pc;
-    if (instruction->execute != nullptr)
-    {
-        instruction->execute(cpu);
-    }
-    
-    cpu->registers->pc += instruction->bytes;
-
-    if (instruction->postExecute != nullptr)
-    {
-        instruction->postExecute(cpu);
-    }
-
-    //std::println("0x{:04X} {}", preExecuteLocation, instruction->name);
-    
     return instruction;
 }
 
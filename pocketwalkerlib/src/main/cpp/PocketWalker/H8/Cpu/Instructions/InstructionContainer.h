@@ -40,7 +40,9 @@ public:
         setup(this);
     }
 
-    Instruction* Execute(Cpu* cpu);
+    // Walks the predicates (and any child containers) down to a leaf
+    // instruction. Only used while building the flat dispatch table.
+    Instruction* Resolve(Opcode* opcode);
 
     void Register(uint32_t first, uint32_t second, const Instruction& instruction);
     void Register(uint32_t first, uint32_t second, InstructionContainer* container);
@@ -1,12 +1,13 @@
 #include "InstructionTable.h"
 
+#include <algorithm>
 #include <format>
 #include <stdexcept>
 #include <print>
-#include <android/log.h>
 
 #include "../Components/Opcode.h"
 #include "../Cpu.h"
+#include "Handlers.h"
 
 InstructionTable::InstructionTable() :
     aH_aL(InstructionContainer("aH/aL",
@@ -33,31 +34,24 @@ InstructionTable::InstructionTable() :
                        "NOP",
                        2,
                        1,
-                       [](const Cpu* cpu){ }
+                       [](Cpu* cpu){ }
                    ));
 
     aH_aL.Register(0x0, 0x8, Instruction(
                        "ADD.B Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-            
-                           cpu->flags->Add(*rd, *rs);
-
-                           *rd += *rs;
-                       }
+                       Handlers::RegisterOperation<uint8_t, Handlers::Add>
                    ));
 
     aH_aL.Register(0x0, 0x7, Instruction(
                        "LDC.B #xx:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint8_t imm = cpu->opcodes->b();
+                           cpu->flags->Discard();
                            cpu->flags->ccr = imm;
                        }
                    ));
@@ -66,155 +60,86 @@ InstructionTable::InstructionTable() :
                        "ADD.W Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
-                           uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-            
-                           cpu->flags->Add(*rd, *rs);
-
-                           *rd += *rs;
-                       }
+                       Handlers::RegisterOperation<uint16_t, Handlers::Add>
                    ));
 
     aH_aL.Register(0x0, 0xC, Instruction(
                        "MOV.B Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-
-                           *rd = *rs;
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint8_t, Handlers::Mov>
                    ));
 
     aH_aL.Register(0x0, 0xD, Instruction(
                        "MOV.W Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
-                           uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-            
-                           *rd = *rs;
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint16_t, Handlers::Mov>
                    ));
     
     aH_aL.Register(0x1, 0x4, Instruction(
                        "OR.B Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-            
-                           *rd |= *rs;
-
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint8_t, Handlers::Or>
                    ));
     
     aH_aL.Register(0x1, 0x5, Instruction(
                        "XOR.B Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-            
-                           *rd ^= *rs;
-            
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint8_t, Handlers::Xor>
                    ));
     
     aH_aL.Register(0x1, 0x6, Instruction(
                        "AND.B Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-            
-                           *rd &= *rs;
-            
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint8_t, Handlers::And>
                    ));
     
     aH_aL.Register(0x1, 0x8, Instruction(
                        "SUB.B Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                           cpu->flags->Sub(*rd, *rs);
-
-                           *rd -= *rs;
-                       }
+                       Handlers::RegisterOperation<uint8_t, Handlers::Sub>
                    ));
     
     aH_aL.Register(0x1, 0x9, Instruction(
                        "SUB.W Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
-                           uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                           cpu->flags->Sub(*rd, *rs);
-
-                           *rd -= *rs;
-                       }
+                       Handlers::RegisterOperation<uint16_t, Handlers::Sub>
                    ));
 
     aH_aL.Register(0x1, 0xC, Instruction(
                        "CMP.B Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
-                           const uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-
-                           cpu->flags->Sub(*rd, *rs);
-                       }
+                       Handlers::RegisterOperation<uint8_t, Handlers::Cmp>
                    ));
 
     aH_aL.Register(0x1, 0xD, Instruction(
                        "CMP.W Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
-                           const uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                           cpu->flags->Sub(*rd, *rs);
-                       }
+                       Handlers::RegisterOperation<uint16_t, Handlers::Cmp>
                    ));
 
     aH_aL.Register(0x1, 0xE, Instruction(
                        "SUBX Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
                            uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
 
+                           cpu->flags->Resolve();
                            cpu->flags->Sub(*rd, static_cast<uint8_t>(*rs + cpu->flags->carry));
             
+                           // Uses the carry the Sub above just produced.
+                           cpu->flags->Resolve();
                            *rd -= *rs + cpu->flags->carry;
                        }
                    ));
@@ -223,191 +148,112 @@ InstructionTable::InstructionTable() :
                        "MOV.B @aa:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->aL());
-                           const uint16_t address = cpu->opcodes->b() | 0xFF00;
-
-                           *rd = cpu->ram->ReadByte(address);
-           
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::Load<uint8_t, Handlers::Absolute8>
                    ));
     
     aH_aL.Register({0x3}, {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                        "MOV.B Rs, @aa:8",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->aL());
-                           const uint16_t address = cpu->opcodes->b() | 0xFF00;
-
-                           cpu->ram->WriteByte(address, *rs);
-                           cpu->flags->Mov(*rs);
-                       }
+                       Handlers::Store<uint8_t, Handlers::Absolute8>
                    ));
 
     aH_aL.Register(0x4, 0x0, Instruction(
                        "BRA d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::Always>
                    ));
 
     aH_aL.Register(0x4, 0x2, Instruction(
                        "BHI d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (!(cpu->flags->carry || cpu->flags->zero))
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::High>
                    ));
 
     aH_aL.Register(0x4, 0x3, Instruction(
                        "BLS d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (cpu->flags->carry || cpu->flags->zero)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::LowOrSame>
                    ));
 
     aH_aL.Register(0x4, 0x4, Instruction(
                        "BCC d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (!cpu->flags->carry)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::CarryClear>
                    ));
 
     aH_aL.Register(0x4, 0x5, Instruction(
                        "BCS d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (cpu->flags->carry)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::CarrySet>
                    ));
 
     aH_aL.Register(0x4, 0x6, Instruction(
                        "BNE d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (!cpu->flags->zero)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::NotEqual>
                    ));
     
     aH_aL.Register(0x4, 0x7, Instruction(
                        "BEQ d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (cpu->flags->zero)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::Equal>
                    ));
     
     aH_aL.Register(0x4, 0xA, Instruction(
                        "BPL d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (!cpu->flags->negative)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::Plus>
                    ));
     
     aH_aL.Register(0x4, 0xB, Instruction(
                        "BMI d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (cpu->flags->negative)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::Minus>
                    ));
     
     aH_aL.Register(0x4, 0xC, Instruction(
                        "BGE d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (cpu->flags->negative == cpu->flags->overflow)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::GreaterOrEqual>
                    ));
     
     aH_aL.Register(0x4, 0xD, Instruction(
                        "BLT d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (cpu->flags->negative != cpu->flags->overflow)
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::Less>
                    ));
     
     aH_aL.Register(0x4, 0xE, Instruction(
                        "BGT d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (!(cpu->flags->zero || (cpu->flags->negative != cpu->flags->overflow)))
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::Greater>
                    ));
     
     aH_aL.Register(0x4, 0xF, Instruction(
                        "BLE d:8",
                        2,
                        2,
-                       [](const Cpu* cpu)
-                       {
-                           const int8_t disp = static_cast<int8_t>(cpu->opcodes->b());
-                           if (cpu->flags->zero || (cpu->flags->negative != cpu->flags->overflow))
-                               cpu->registers->pc += disp;
-                       }
+                       Handlers::Branch<int8_t, Handlers::LessOrEqual>
                    ));
     
     aH_aL.Register(0x5, 0x0, Instruction(
                        "MULXU.B Rs, Rd",
                        2,
                        1 + 12,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
                            uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
@@ -421,7 +267,7 @@ InstructionTable::InstructionTable() :
                        "DIVXU.B Rs, Rd",
                        2,
                        1 + 12,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bH());
                            uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
@@ -431,6 +277,7 @@ InstructionTable::InstructionTable() :
 
                            *rd = (remainder << 8) | quotient;
 
+                           cpu->flags->Resolve();
                            cpu->flags->zero = quotient == 0;
                            cpu->flags->negative = quotient & Flags::NegativeMask(8);
            
@@ -441,7 +288,7 @@ InstructionTable::InstructionTable() :
                        "MULXU.W Rs, ERd",
                        2,
                        1 + 20,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
                            uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
@@ -455,7 +302,7 @@ InstructionTable::InstructionTable() :
                        "DIVXU.W Rs, ERd",
                        2,
                        1 + 20,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
                            uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
@@ -465,6 +312,7 @@ InstructionTable::InstructionTable() :
 
                            *erd = (remainder << 16) | quotient;
 
+                           cpu->flags->Resolve();
                            cpu->flags->zero = quotient == 0;
                            cpu->flags->negative = quotient & Flags::NegativeMask(16);
            
@@ -476,7 +324,7 @@ InstructionTable::InstructionTable() :
                        2,
                        2 + 1 + 2,
                        nullptr,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            cpu->registers->pc = cpu->registers->PopStack();
                        }
@@ -487,7 +335,7 @@ InstructionTable::InstructionTable() :
                        2,
                        2 + 1,
                        nullptr,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            cpu->registers->PushStack();
             
@@ -501,9 +349,10 @@ InstructionTable::InstructionTable() :
                        2,
                        2 + 2 + 2,
                        nullptr,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            cpu->registers->pc = cpu->interrupts->savedAddress;
+                           cpu->flags->Discard();
                            cpu->flags->ccr = cpu->interrupts->savedFlags;
                        }
                    ));
@@ -514,7 +363,7 @@ InstructionTable::InstructionTable() :
                        2,
                        2 + 2,
                        nullptr,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint32_t* ern = cpu->registers->Register32(cpu->opcodes->bH());
                            cpu->registers->pc = *ern & 0xFFFF;
@@ -526,7 +375,7 @@ InstructionTable::InstructionTable() :
                        4,
                        2 + 2,
                        nullptr,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint32_t address = (cpu->opcodes->b() << 16) | cpu->opcodes->cd();
                            cpu->registers->pc = address;
@@ -538,7 +387,7 @@ InstructionTable::InstructionTable() :
                        2,
                        2 + 1,
                        nullptr,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            cpu->registers->PushStack();
             
@@ -552,7 +401,7 @@ InstructionTable::InstructionTable() :
                        4,
                        2 + 1 + 2,
                        nullptr,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            cpu->registers->PushStack();
             
@@ -565,22 +414,14 @@ InstructionTable::InstructionTable() :
                        "OR.W Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
-                           uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                           *rd |= *rs;
-
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint16_t, Handlers::Or>
                    ));
     
     aH_aL.Register(0x6, 0x0, Instruction(
                        "BSET Rn, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            uint8_t* rn = cpu->registers->Register8(cpu->opcodes->bH());
                            uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
@@ -593,41 +434,26 @@ InstructionTable::InstructionTable() :
                        "XOR.W Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
-                           uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                           *rd ^= *rs;
-
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint16_t, Handlers::Xor>
                    ));
 
     aH_aL.Register(0x6, 0x6, Instruction(
                        "AND.W Rs, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bH());
-                           uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                           *rd &= *rs;
-
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::RegisterOperation<uint16_t, Handlers::And>
                    ));
 
     aH_aL.Register(0x6, 0x7, Instruction(
                        "BST #xx:3, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint8_t imm = cpu->opcodes->bH() & 0b111;
                            uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
 
+                           cpu->flags->Resolve();
                            bool isOne = cpu->flags->carry;
             
                            const bool isInverted = cpu->opcodes->bH() & 0b1000;
@@ -658,28 +484,14 @@ InstructionTable::InstructionTable() :
                                     "MOV.B Rs, @ERd",
                                     2,
                                     1 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bL());
-                                        uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
-
-                                        cpu->ram->WriteByte(*erd, *rs);
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint8_t, Handlers::Indirect>
                                 ));
 
             container->Register(false, 0, Instruction(
                                     "MOV.B @ERs, Rd",
                                     2,
                                     1 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                                        uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                                        *rd = cpu->ram->ReadByte(*ers);
-
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint8_t, Handlers::Indirect>
                                 ));
         })
     );
@@ -695,28 +507,14 @@ InstructionTable::InstructionTable() :
                                     "MOV.W Rs, @ERd",
                                     2,
                                     1 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bL());
-                                        uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
-
-                                        cpu->ram->WriteShort(*erd, *rs);
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint16_t, Handlers::Indirect>
                                 ));
 
             container->Register(false, 0, Instruction(
                                     "MOV.W @ERs, Rd",
                                     2,
                                     1 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                                        uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                                        *rd = cpu->ram->ReadShort(*ers);
-
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint16_t, Handlers::Indirect>
                                 ));
         })
     );
@@ -731,59 +529,28 @@ InstructionTable::InstructionTable() :
                                     "MOV.B @aa:16, Rd",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                                        const uint16_t address = cpu->opcodes->cd();
-                    
-                                        *rd = cpu->ram->ReadByte(address);
-
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint8_t, Handlers::Absolute16>
                                 ));
 
             container->Register(0x6A, 0x2, Instruction(
                                     "MOV.B @aa:24, Rd",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                                        const uint32_t address = (cpu->opcodes->cd() << 16) | cpu->opcodes->ef();
-                    
-                                        *rd = cpu->ram->ReadByte(address);
-
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint8_t, Handlers::Absolute24>
                                 ));
             
             container->Register(0x6A, 0x8, Instruction(
                                     "MOV.B Rs, @aa:16",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bL());
-                                        const uint16_t address = cpu->opcodes->cd();
-                                        cpu->ram->WriteByte(address, *rs);
-
-
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint8_t, Handlers::Absolute16>
                                 ));
             
             container->Register(0x6A, 0xA, Instruction(
                                     "MOV.B Rs, @aa:24",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bL());
-                                        const uint32_t address = (cpu->opcodes->cd() << 16) | cpu->opcodes->ef();
-                                        cpu->ram->WriteByte(address, *rs);
-                   
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint8_t, Handlers::Absolute24>
                                 )); 
         })
     );
@@ -798,58 +565,28 @@ InstructionTable::InstructionTable() :
                                     "MOV.W @aa:16, Rd",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                                        const uint16_t address = cpu->opcodes->cd();
-                    
-                                        *rd = cpu->ram->ReadShort(address);
-
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint16_t, Handlers::Absolute16>
                                 ));
 
             container->Register(0x6B, 0x2, Instruction(
                                     "MOV.W @aa:24, Rd",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                                        const uint32_t address = (cpu->opcodes->cd() << 16) | cpu->opcodes->ef();
-
-                                        *rd = cpu->ram->ReadShort(address);
-
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint16_t, Handlers::Absolute24>
                                 ));
             
             container->Register(0x6B, 0x8, Instruction(
                                     "MOV.W Rs, @aa:16",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bL());
-                                        const uint16_t address = cpu->opcodes->cd();
-                                        cpu->ram->WriteShort(address, *rs);
-
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint16_t, Handlers::Absolute16>
                                 ));
             
             container->Register(0x6B, 0xA, Instruction(
                                     "MOV.W Rs, @aa:24",
                                     4,
                                     2+1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bL());
-                                        const uint32_t address = cpu->opcodes->cd() << 16 | cpu->opcodes->ef();
-                                        cpu->ram->WriteShort(address, *rs);
-                   
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint16_t, Handlers::Absolute24>
                                 )); 
         })
     );
@@ -864,32 +601,14 @@ InstructionTable::InstructionTable() :
                                     "MOV.B Rs, @-ERd",
                                     2,
                                     1 + 1 + 2,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bL());
-                                        uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
-
-                                        *erd -= 1;
-
-                                        cpu->ram->WriteByte(*erd, *rs);
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint8_t, Handlers::PreDecrement>
                                 ));
 
             container->Register(false, 0, Instruction(
                                     "MOV.B @ERs+, Rd",
                                     2,
                                     1 + 1 + 2,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                                        uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                    
-                                        *rd = cpu->ram->ReadByte(*ers);
-                                        *ers += 1;
-
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint8_t, Handlers::PostIncrement>
                                 ));
         })
     );
@@ -904,32 +623,14 @@ InstructionTable::InstructionTable() :
                                     "MOV.W Rs, @-ERd",
                                     2,
                                     1 + 1 + 2,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bL());
-                                        uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
-
-                                        *erd -= 2;
-
-                                        cpu->ram->WriteShort(*erd, *rs);
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint16_t, Handlers::PreDecrement>
                                 ));
 
             container->Register(0x6D, false, Instruction(
                                     "MOV.W @ERs+, Rd",
                                     2,
                                     1 + 1 + 2,
-                                    [](const Cpu* cpu)
-                                    {
-                                        uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                                        uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                    
-                                        *rd = cpu->ram->ReadShort(*ers);
-                                        *ers += 2;
-                    
-                                        cpu->flags->Mov(*rd);
-                                    }
+                                    Handlers::Load<uint16_t, Handlers::PostIncrement>
                                 ));
         })
     );
@@ -944,35 +645,14 @@ InstructionTable::InstructionTable() :
                                     "MOV.B Rs, @(d:16,ERd)",
                                     4,
                                     2 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const int16_t disp = cpu->opcodes->cd();
-                    
-                                        const uint8_t* rs = cpu->registers->Register8(cpu->opcodes->bL());
-                                        uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
-
-                                        cpu->ram->WriteByte(*erd + disp, *rs);
-
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint8_t, Handlers::Displacement16>
                                 ));
 
             container->Register(false, 0, Instruction(
                                     "MOV.B @(d:16,ERs), Rd ",
                                     4,
                                     2 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const int16_t disp = cpu->opcodes->cd();
-
-                                        uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                                        uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-
-                                        *rd = cpu->ram->ReadByte(*ers + disp);
-
-                                        cpu->flags->Mov(*rd);
-                    
-                                    }
+                                    Handlers::Load<uint8_t, Handlers::Displacement16>
                                 ));
         })
     );
@@ -987,35 +667,14 @@ InstructionTable::InstructionTable() :
                                     "MOV.W Rs, @(d:16,ERd)",
                                     4,
                                     2 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const int16_t disp = cpu->opcodes->cd();
-                    
-                                        const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->bL());
-                                        uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
-
-                                        cpu->ram->WriteShort(*erd + disp, *rs);
-
-                                        cpu->flags->Mov(*rs);
-                                    }
+                                    Handlers::Store<uint16_t, Handlers::Displacement16>
                                 ));
 
             container->Register(false, 0, Instruction(
                                     "MOV.W @(d:16,ERs), Rd ",
                                     4,
                                     2 + 1,
-                                    [](const Cpu* cpu)
-                                    {
-                                        const int16_t disp = cpu->opcodes->cd();
-
-                                        uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                                        uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                                        *rd = cpu->ram->ReadShort(*ers + disp);
-
-                                        cpu->flags->Mov(*rd);
-                    
-                                    }
+                                    Handlers::Load<uint16_t, Handlers::Displacement16>
                                 ));
         })
     );
@@ -1024,7 +683,7 @@ InstructionTable::InstructionTable() :
                        "BSET #xx:3, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint8_t imm = cpu->opcodes->bH() & 0b111;
                            uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
@@ -1037,11 +696,12 @@ InstructionTable::InstructionTable() :
                        "BTST #xx:3, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            const uint8_t imm = cpu->opcodes->bH() & 0b111;
                            const uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
 
+                           cpu->flags->Resolve();
                            cpu->flags->zero = !((*rd >> imm) & 1);
                        }
                    ));
@@ -1050,7 +710,7 @@ InstructionTable::InstructionTable() :
                        "BLD.B #xx:3, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
+                       [](Cpu* cpu)
                        {
                            if (cpu->opcodes->bH() & 0b1000)
                            {
@@ -1060,6 +720,7 @@ InstructionTable::InstructionTable() :
                            const uint8_t imm = cpu->opcodes->bH() & 0b111;
                            const uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
 
+                           cpu->flags->Resolve();
                            cpu->flags->carry =(*rd >> imm) & 1;
                        }
                    ));
@@ -1068,86 +729,42 @@ InstructionTable::InstructionTable() :
                        "ADD.B #xx:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t imm = cpu->opcodes->b();
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->aL());
-
-                           cpu->flags->Add(*rd, imm);
-
-                           *rd += imm;
-                       }
+                       Handlers::ImmediateOperation<uint8_t, Handlers::Add>
                    ));
     
     aH_aL.Register({0xA}, {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                        "CMP.B #xx:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t imm = cpu->opcodes->b();
-                           const uint8_t* rd = cpu->registers->Register8(cpu->opcodes->aL());
-
-                           cpu->flags->Sub(*rd, imm);
-                       }
+                       Handlers::ImmediateOperation<uint8_t, Handlers::Cmp>
                    ));
 
     aH_aL.Register({0xC}, {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                        "OR.B #xx:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t imm = cpu->opcodes->b();
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->aL());
-
-                           *rd |= imm;
-
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::ImmediateOperation<uint8_t, Handlers::Or>
                    ));
 
     aH_aL.Register({0xD}, {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                        "XOR.B #xx:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t imm = cpu->opcodes->b();
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->aL());
-
-                           *rd ^= imm;
-
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::ImmediateOperation<uint8_t, Handlers::Xor>
                    ));
 
     aH_aL.Register({0xE}, {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                        "AND.B #xx:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t imm = cpu->opcodes->b();
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->aL());
-
-                           *rd &= imm;
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::ImmediateOperation<uint8_t, Handlers::And>
                    ));
 
     aH_aL.Register({0xF}, {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                        "MOV.B #xx:8, Rd",
                        2,
                        1,
-                       [](const Cpu* cpu)
-                       {
-                           const uint8_t imm = cpu->opcodes->b();
-                           uint8_t* rd = cpu->registers->Register8(cpu->opcodes->aL());
-
-                           *rd = imm;
-                           cpu->flags->Mov(*rd);
-                       }
+                       Handlers::ImmediateOperation<uint8_t, Handlers::Mov>
                    ));
 
     aHaL_bH.Register(0x1, 0x0, new InstructionContainer(
@@ -1166,30 +783,14 @@ InstructionTable::InstructionTable() :
                                             "MOV.L ERs, @ERd",
                                             4,
                                             2 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dL());
-                                                const uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dH());
-
-                                                cpu->ram->WriteInt(*erd, *ers);
-
-                                                cpu->flags->Mov(*ers);
-                                            }
+                                            Handlers::Store<uint32_t, Handlers::Indirect>
                                         ));
 
                     container->Register(false, 0, Instruction(
                                             "MOV.L @ERs, ERd",
                                             4,
                                             2 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dH());
-                                                uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
-                            
-                                                *erd = cpu->ram->ReadInt(*ers);
-                            
-                                                cpu->flags->Mov(*erd);
-                                            }
+                                            Handlers::Load<uint32_t, Handlers::Indirect>
                                         ));
                 }
             ));
@@ -1204,61 +805,28 @@ InstructionTable::InstructionTable() :
                                             "MOV.L @aa:16, ERd",
                                             6,
                                             3 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const uint16_t address = cpu->opcodes->ef();
-                                                uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
-                          
-                                                *erd = cpu->ram->ReadInt(address);
-
-                                                cpu->flags->Mov(*erd);
-                                            }
+                                            Handlers::Load<uint32_t, Handlers::Absolute16>
                                         ));
 
                     container->Register(0x2, 0, Instruction(
                                             "MOV.L @aa:32, ERd",
                                             8,
                                             3 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const uint32_t address = (cpu->opcodes->ef() << 16) | cpu->opcodes->gh();
-                                                uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
-                          
-                                                *erd = cpu->ram->ReadInt(address);
-
-                                                cpu->flags->Mov(*erd);
-                                            }
+                                            Handlers::Load<uint32_t, Handlers::Absolute24>
                                         ));
                     
                     container->Register(0x8, 0, Instruction(
                                             "MOV.L ERs, @aa:16",
                                             6,
                                             3 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dL());
-                                                const uint16_t address = cpu->opcodes->ef();
-
-                                                cpu->ram->WriteInt(address, *ers);
-
-                                                cpu->flags->Mov(*ers);
-                                            }
+                                            Handlers::Store<uint32_t, Handlers::Absolute16>
                                         ));
 
                     container->Register(0xA, 0, Instruction(
                                             "MOV.L ERs, @aa:32",
                                             8,
                                             3 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dL());
-                                                const uint32_t address = (cpu->opcodes->ef() << 16) | cpu->opcodes->gh();
-
-                                                cpu->ram->WriteInt(address, *ers);
-
-                            
-                                                cpu->flags->Mov(*ers);
-                                            }
+                                            Handlers::Store<uint32_t, Handlers::Absolute24>
                                         ));
                 }
             ));
@@ -1273,34 +841,14 @@ InstructionTable::InstructionTable() :
                                             "MOV.L ERs, @-ERd",
                                             4,
                                             2 + 2 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dL());
-                                                uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dH());
-
-                                                *erd -= 4;
-
-                                                cpu->ram->WriteInt(*erd, *ers);
-
-                                                cpu->flags->Mov(*ers);
-                                            }
+                                            Handlers::Store<uint32_t, Handlers::PreDecrement>
                                         ));
 
                     container->Register(false, 0, Instruction(
                                             "MOV.L @ERs+, ERd",
                                             4,
                                             2 + 2 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dH());
-                                                uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
-                            
-                                                *erd = cpu->ram->ReadInt(*ers);
-                            
-                                                *ers += 4;
-                            
-                                                cpu->flags->Mov(*erd);
-                                            }
+                                            Handlers::Load<uint32_t, Handlers::PostIncrement>
                                         ));
                 }
             ));
@@ -1315,34 +863,14 @@ InstructionTable::InstructionTable() :
                                             "MOV.L ERs, @(d:16,ERd)",
                                             6,
                                             3 + 2,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const int16_t disp = cpu->opcodes->ef();
-                    
-                                                const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dL());
-                                                const uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dH());
-
-                                                cpu->ram->WriteInt(*erd + disp, *ers);
-
-                                                cpu->flags->Mov(*ers);
-                                            }
+                                            Handlers::Store<uint32_t, Handlers::Displacement16>
                                         ));
 
                     container->Register(false, 0, Instruction(
                                             "MOV.L @(d:16,ERs), ERd",
                                             6,
                                             3 + 2 ,
-                                            [](const Cpu* cpu)
-                                            {
-                                                const int16_t disp = cpu->opcodes->ef();
-
-                                                const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dH());
-                                                uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
-
-                                                *erd = cpu->ram->ReadInt(*ers + disp);
-
-                                                cpu->flags->Mov(*erd);
-                                            }
+                                            Handlers::Load<uint32_t, Handlers::Displacement16>
                                         ));
                 }
             ));
@@ -1372,267 +900,133 @@ InstructionTable::InstructionTable() :
                          "INC.B Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                             cpu->flags->Inc(*rd, 1);
-        
-                             *rd += 1;
-                         }
+                         Handlers::Increment<uint8_t, 1>
                      ));
 
     aHaL_bH.Register({0xA}, {0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                          "ADD.L ERs, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             const uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-            
-                             cpu->flags->Add(*erd, *ers);
-
-                             *erd += *ers;
-                         }
+                         Handlers::RegisterOperation<uint32_t, Handlers::Add>
                      ));
 
     aHaL_bH.Register(0xB, 0x0, Instruction(
                          "ADDS #1, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             *erd += 1;
-                         }
+                         Handlers::AddAddress<1>
                      ));
 
     aHaL_bH.Register(0xB, 0x5, Instruction(
                          "INC.W #1, Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                             cpu->flags->Inc(*rd, 1);
-        
-                             *rd += 1;
-                         }
+                         Handlers::Increment<uint16_t, 1>
                      ));
 
     aHaL_bH.Register(0xB, 0x7, Instruction(
                          "INC.L #1, Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* rd = cpu->registers->Register32(cpu->opcodes->bL());
-                             cpu->flags->Inc(*rd, 1);
-        
-                             *rd += 1;
-                         }
+                         Handlers::Increment<uint32_t, 1>
                      ));
 
     aHaL_bH.Register(0xB, 0x8, Instruction(
                          "ADDS #2, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             *erd += 2;
-                         }
+                         Handlers::AddAddress<2>
                      ));
 
     aHaL_bH.Register(0xB, 0x9, Instruction(
                          "ADDS #4, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             *erd += 4;
-                         }
+                         Handlers::AddAddress<4>
                      ));
 
     aHaL_bH.Register(0xB, 0xD, Instruction(
                          "INC.W #2, Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                             cpu->flags->Inc(*rd, 2);
-        
-                             *rd += 2;
-                         }
+                         Handlers::Increment<uint16_t, 2>
                      ));
     
     aHaL_bH.Register({0xF}, {0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                          "MOV.L ERs, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-
-                             *erd = *ers;
-
-                             cpu->flags->Mov(*erd);
-                         }
+                         Handlers::RegisterOperation<uint32_t, Handlers::Mov>
                      ));
     
     aHaL_bH.Register(0x10, 0x0, Instruction(
                          "SHLL.B Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                             cpu->flags->carry = *rd & Flags::NegativeMask(8);
-                             *rd <<= 1;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftLeft<uint8_t>
                      ));
     
     aHaL_bH.Register(0x10, 0x1, Instruction(
                          "SHLL.W Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                             cpu->flags->carry = *rd & Flags::NegativeMask(16);
-                             *rd <<= 1;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftLeft<uint16_t>
                      ));
     
     aHaL_bH.Register(0x10, 0x3, Instruction(
                          "SHLL.L ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* rd = cpu->registers->Register32(cpu->opcodes->bL());
-                             cpu->flags->carry = *rd & Flags::NegativeMask(32);
-                             *rd <<= 1;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftLeft<uint32_t>
                      ));
     
     aHaL_bH.Register(0x11, 0x0, Instruction(
                          "SHLR.B Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                             cpu->flags->carry = *rd & 1;
-                             *rd >>= 1;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftRight<uint8_t>
                      ));
     
     aHaL_bH.Register(0x11, 0x1, Instruction(
                          "SHLR.W Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                             cpu->flags->carry = *rd & 1;
-                             *rd >>= 1;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftRight<uint16_t>
                      ));
     
     aHaL_bH.Register(0x11, 0x3, Instruction(
                          "SHLR.L ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* rd = cpu->registers->Register32(cpu->opcodes->bL());
-                             cpu->flags->carry = *rd & 1;
-                             *rd >>= 1;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftRight<uint32_t>
                      ));
     
     aHaL_bH.Register(0x11, 0x9, Instruction(
                          "SHAR.W Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-           
-                             cpu->flags->carry = *rd & 1;
-           
-                             *rd = (*rd >> 1) | (*rd & Flags::NegativeMask(16));
-           
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftRightArithmetic<uint16_t>
                      ));
     
     aHaL_bH.Register(0x11, 0xB, Instruction(
                          "SHAR.L Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* rd = cpu->registers->Register32(cpu->opcodes->bL());
-           
-                             cpu->flags->carry = *rd & 1;
-           
-                             *rd = (*rd >> 1) | (*rd & Flags::NegativeMask(32));
-           
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ShiftRightArithmetic<uint32_t>
                      ));
     
     aHaL_bH.Register(0x12, 0x8, Instruction(
                          "ROTL.B Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-
-                             const uint8_t msb = (*rd >> 7) & 1;
-                             *rd = (*rd << 1) | msb;
-           
-                             cpu->flags->carry = msb;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::RotateLeft<uint8_t>
                      ));
     
     aHaL_bH.Register(0x12, 0x9, Instruction(
                          "ROTL.W Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             const uint8_t msb = (*rd >> 15) & 1;
-                             *rd = (*rd << 1) | msb;
-           
-                             cpu->flags->carry = msb;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::RotateLeft<uint16_t>
                      ));
 
     
@@ -1640,24 +1034,14 @@ InstructionTable::InstructionTable() :
                          "ROTR.B Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-
-                             const uint8_t lsb = *rd & 1;
-                             *rd = (*rd >> 1) | (lsb << 7);
-           
-                             cpu->flags->carry = lsb;
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::RotateRight<uint8_t>
                      ));
     
     aHaL_bH.Register(0x17, 0x0, Instruction(
                          "NOT.B Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
+                         [](Cpu* cpu)
                          {
                              uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
                              *rd = ~*rd;
@@ -1671,94 +1055,42 @@ InstructionTable::InstructionTable() :
                          "EXTU.W Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                             *rd &= 0xFF;
-
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::ZeroExtend<uint16_t>
                      ));
 
     aHaL_bH.Register(0x17, 0x7, Instruction(
                          "EXTU.L ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             *erd &= 0xFFFF;
-
-                             cpu->flags->Mov(*erd);
-
-                         }
+                         Handlers::ZeroExtend<uint32_t>
                      ));
 
     aHaL_bH.Register(0x17, 0x8, Instruction(
                          "NEG.B",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                             cpu->flags->Sub(static_cast<uint8_t>(0), *rd);
-            
-                             if (*rd != Flags::NegativeMask(8))
-                             {
-                                 *rd = -*rd;
-                             }
-            
-                         }
+                         Handlers::Negate<uint8_t>
                      ));
 
     aHaL_bH.Register(0x17, 0x9, Instruction(
                          "NEG.W Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                             cpu->flags->Sub(static_cast<uint16_t>(0), *rd);
-            
-                             if (*rd != Flags::NegativeMask(16))
-                             {
-                                 *rd = -*rd;
-                             }
-            
-                         }
+                         Handlers::Negate<uint16_t>
                      ));
     
     aHaL_bH.Register(0x17, 0xD, Instruction(
                          "EXTS.W Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             const int8_t firstPart = static_cast<int8_t>(*rd & 0xFF);
-                             *rd = static_cast<int16_t>(firstPart);
-
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::SignExtend<uint16_t>
                      ));
     
     aHaL_bH.Register(0x17, 0xF, Instruction(
                          "EXTS.L Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* rd = cpu->registers->Register32(cpu->opcodes->bL());
-
-                             const int16_t firstPart = static_cast<int16_t>(*rd & 0xFFFF);
-                             *rd = static_cast<int32_t>(firstPart);
-
-                             cpu->flags->Mov(*rd);
-
-                         }
+                         Handlers::SignExtend<uint32_t>
                      ));
     
 
@@ -1766,343 +1098,189 @@ InstructionTable::InstructionTable() :
                          "DEC.B ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint8_t* rd = cpu->registers->Register8(cpu->opcodes->bL());
-                             cpu->flags->Dec(*rd, 1);
-           
-                             *rd -= 1;
-
-                         }
+                         Handlers::Decrement<uint8_t, 1>
                      ));
     
     aHaL_bH.Register({0x1A}, {0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                          "SUB.L ERs, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             cpu->flags->Sub(*erd, *ers);
-
-                             *erd -= *ers;
-           
-                         }
+                         Handlers::RegisterOperation<uint32_t, Handlers::Sub>
                      ));
     
     aHaL_bH.Register(0x1B, 0x5, Instruction(
                          "DEC.W #1, Rd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-                             cpu->flags->Dec(*rd, 1);
-           
-                             *rd -= 1;
-                         }
+                         Handlers::Decrement<uint16_t, 1>
                      ));
     
     aHaL_bH.Register(0x1B, 0x8, Instruction(
                          "SUBS #2, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             *erd -= 2;
-                         }
+                         Handlers::AddAddress<-2>
                      ));
 
     aHaL_bH.Register(0x1B, 0x9, Instruction(
                          "SUBS #4, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-                             *erd -= 4;
-                         }
+                         Handlers::AddAddress<-4>
                      ));
 
     aHaL_bH.Register({0x1F}, {0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF}, Instruction(
                          "CMP.L ERs, ERd",
                          2,
                          1,
-                         [](const Cpu* cpu)
-                         {
-                             uint32_t* ers = cpu->registers->Register32(cpu->opcodes->bH());
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-
-                             cpu->flags->Sub(*erd, *ers);
-                         }
+                         Handlers::RegisterOperation<uint32_t, Handlers::Cmp>
                      ));
 
     aHaL_bH.Register(0x58, 0x2, Instruction(
                          "BHI d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (!(cpu->flags->carry || cpu->flags->zero))
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::High>
                      ));
 
     aHaL_bH.Register(0x58, 0x3, Instruction(
                          "BLS d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (cpu->flags->carry || cpu->flags->zero)
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::LowOrSame>
                      ));
 
     aHaL_bH.Register(0x58, 0x4, Instruction(
                          "BCC d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (!cpu->flags->carry)
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::CarryClear>
                      ));
 
     aHaL_bH.Register(0x58, 0x5, Instruction(
                          "BCS d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (cpu->flags->carry)
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::CarrySet>
                      ));
 
     aHaL_bH.Register(0x58, 0x6, Instruction(
                          "BNE d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (!cpu->flags->zero)
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::NotEqual>
                      ));
 
     aHaL_bH.Register(0x58, 0x7, Instruction(
                          "BEQ d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (cpu->flags->zero)
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::Equal>
                      ));
 
     aHaL_bH.Register(0x58, 0xC, Instruction(
                          "BGE d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (cpu->flags->negative == cpu->flags->overflow)
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::GreaterOrEqual>
                      ));
 
     aHaL_bH.Register(0x58, 0xD, Instruction(
                          "BLT d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (cpu->flags->negative != cpu->flags->overflow)
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::Less>
                      ));
 
     aHaL_bH.Register(0x58, 0xE, Instruction(
                          "BGT d:16",
                          4,
                          2 + 2,
-                         [](const Cpu* cpu)
-                         {
-                             const int16_t disp = static_cast<int16_t>(cpu->opcodes->cd());
-                             if (!(cpu->flags->zero || (cpu->flags->negative != cpu->flags->overflow)))
-                                 cpu->registers->pc += disp;
-                         }
+                         Handlers::Branch<int16_t, Handlers::Greater>
                      ));
 
     aHaL_bH.Register(0x79, 0x0, Instruction(
                          "MOV.W #xx:16, Rd",
                          4,
                          2,
-                         [](const Cpu* cpu)
-                         {
-                             const uint16_t imm = cpu->opcodes->cd();
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             *rd = imm;
-                             cpu->flags->Mov(imm);
-                         }
+                         Handlers::ImmediateOperation<uint16_t, Handlers::Mov>
                      ));
 
     aHaL_bH.Register(0x79, 0x1, Instruction(
                          "ADD.W #xx:16, Rd",
                          4,
                          2,
-                         [](const Cpu* cpu)
-                         {
-                             const uint16_t imm = cpu->opcodes->cd();
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             cpu->flags->Add(*rd, imm);
-
-                             *rd += imm;
-                         }
+                         Handlers::ImmediateOperation<uint16_t, Handlers::Add>
                      ));
 
     aHaL_bH.Register(0x79, 0x2, Instruction(
                          "CMP.W #xx:16, Rd",
                          4,
                          2,
-                         [](const Cpu* cpu)
-                         {
-                             const uint16_t imm = cpu->opcodes->cd();
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             cpu->flags->Sub(*rd, imm);
-                         }
+                         Handlers::ImmediateOperation<uint16_t, Handlers::Cmp>
                      ));
 
     aHaL_bH.Register(0x79, 0x3, Instruction(
                          "SUB.W #xx:16, Rd",
                          4,
                          2,
-                         [](const Cpu* cpu)
-                         {
-                             const uint16_t imm = cpu->opcodes->cd();
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             cpu->flags->Sub(*rd, imm);
-
-                             *rd -= imm;
-                         }
+                         Handlers::ImmediateOperation<uint16_t, Handlers::Sub>
                      ));
 
     aHaL_bH.Register(0x79, 0x4, Instruction(
                          "OR.W #xx:16, Rd",
                          4,
                          2,
-                         [](const Cpu* cpu)
-                         {
-                             const uint16_t imm = cpu->opcodes->cd();
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             *rd |= imm;
-            
-                             cpu->flags->Mov(*rd);
-                         }
+                         Handlers::ImmediateOperation<uint16_t, Handlers::Or>
                      ));
 
     aHaL_bH.Register(0x79, 0x6, Instruction(
                          "AND.W #xx:16, Rd",
                          4,
                          2,
-                         [](const Cpu* cpu)
-                         {
-                             const uint16_t imm = cpu->opcodes->cd();
-                             uint16_t* rd = cpu->registers->Register16(cpu->opcodes->bL());
-
-                             *rd &= imm;
-            
-                             cpu->flags->Mov(*rd);
-                         }
+                         Handlers::ImmediateOperation<uint16_t, Handlers::And>
                      ));
 
     aHaL_bH.Register(0x7A, 0x0, Instruction(
                          "MOV.L #xx:32, ERd",
                          6,
                          3,
-                         [](const Cpu* cpu)
-                         {
-                             const uint32_t imm = cpu->opcodes->cd() << 16 | cpu->opcodes->ef();
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-
-                             *erd = imm;
-           
-                             cpu->flags->Mov(*erd);
-                         }
+                         Handlers::ImmediateOperation<uint32_t, Handlers::Mov>
                      ));
 
     aHaL_bH.Register(0x7A, 0x1, Instruction(
                          "ADD.L #xx:32, ERd",
                          6,
                          3,
-                         [](const Cpu* cpu)
-                         {
-                             const uint32_t imm = cpu->opcodes->cd() << 16 | cpu->opcodes->ef();
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-           
-                             cpu->flags->Add(*erd, imm);
-
-                             *erd += imm;
-                         }
+                         Handlers::ImmediateOperation<uint32_t, Handlers::Add>
                      ));
 
     aHaL_bH.Register(0x7A, 0x2, Instruction(
                          "CMP.L #xx:32, ERd",
                          6,
                          3,
-                         [](const Cpu* cpu)
-                         {
-                             const uint32_t imm = cpu->opcodes->cd() << 16 | cpu->opcodes->ef();
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-           
-                             cpu->flags->Sub(*erd, imm);
-                         }
+                         Handlers::ImmediateOperation<uint32_t, Handlers::Cmp>
                      ));
 
     aHaL_bH.Register(0x7A, 0x6, Instruction(
                          "AND.L #xx:32, ERd",
                          6,
                          3,
-                         [](const Cpu* cpu)
-                         {
-                             const uint32_t imm = cpu->opcodes->cd() << 16 | cpu->opcodes->ef();
-                             uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bL());
-           
-                             *erd &= imm;
-
-                             cpu->flags->Mov(*erd);
-                         }
+                         Handlers::ImmediateOperation<uint32_t, Handlers::And>
                      ));
 
     aHaLbHbLcH_cL.Register(0x1C05, 0x2, Instruction(
                                "MULXS.W Rs, ERd",
                                4,
                                2 + 20,
-                               [](const Cpu* cpu)
+                               [](Cpu* cpu)
                                {
                                    uint16_t* rs = cpu->registers->Register16(cpu->opcodes->dH());
                                    uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
 
                                    *erd = (*erd & 0xFFFF) * *rs;
 
+                                   cpu->flags->Resolve();
                                    cpu->flags->zero = *erd == 0;
                                    cpu->flags->negative = *erd & Flags::NegativeMask(32);
                                }
@@ -2112,7 +1290,7 @@ InstructionTable::InstructionTable() :
                                "DIVXS.W Rs, ERd",
                                4,
                                2 + 20,
-                               [](const Cpu* cpu)
+                               [](Cpu* cpu)
                                {
                                    const uint16_t* rs = cpu->registers->Register16(cpu->opcodes->dH());
                                    uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
@@ -2122,6 +1300,7 @@ InstructionTable::InstructionTable() :
 
                                    *erd = (remainder << 16) | quotient;
 
+                                   cpu->flags->Resolve();
                                    cpu->flags->zero = quotient == 0;
                                    cpu->flags->negative = quotient < 0;
             
@@ -2132,16 +1311,7 @@ InstructionTable::InstructionTable() :
                                "XOR.L ERs, ERd",
                                4,
                                2,
-                               [](const Cpu* cpu)
-                               {
-                                   uint32_t* ers = cpu->registers->Register32(cpu->opcodes->dH());
-                                   uint32_t* erd = cpu->registers->Register32(cpu->opcodes->dL());
-
-                                   *erd = *ers ^ *erd;
-
-                                   cpu->flags->Mov(*erd);
-            
-                               }
+                               Handlers::RegisterOperation<uint32_t, Handlers::Xor, true>
                            ));
     
     aHaLbHbLcH_cL.Register(
@@ -2151,7 +1321,7 @@ InstructionTable::InstructionTable() :
           "BLD #xx:3, @ERd",
           4,
           2 + 2,
-          [](const Cpu* cpu)
+          [](Cpu* cpu)
           {
               if (cpu->opcodes->dH() & 0b1000)
               {
@@ -2162,6 +1332,7 @@ InstructionTable::InstructionTable() :
               const uint8_t memoryValue = cpu->ram->ReadByte(*erd);
               const uint8_t imm = cpu->opcodes->dH() & 0b111;
               
+              cpu->flags->Resolve();
               cpu->flags->carry = (memoryValue >> imm) & 1;
           }
       )
@@ -2174,7 +1345,7 @@ InstructionTable::InstructionTable() :
           "BST #xx:3, @ERd",
           4,
           2 + 2,
-          [](const Cpu* cpu)
+          [](Cpu* cpu)
           {
               if (cpu->opcodes->dH() & 0b1000)
               {
@@ -2185,6 +1356,7 @@ InstructionTable::InstructionTable() :
               const uint8_t memoryValue = cpu->ram->ReadByte(*erd);
               const uint8_t imm = cpu->opcodes->dH() & 0b111;
 
+              cpu->flags->Resolve();
               if (cpu->flags->carry) {
                   cpu->ram->WriteByte(*erd, memoryValue | 1 << imm);
               } else {
@@ -2201,7 +1373,7 @@ InstructionTable::InstructionTable() :
            "BSET #xx:3 @ERd",
            4,
            2 + 2,
-           [](const Cpu* cpu)
+           [](Cpu* cpu)
            {
                const uint8_t imm = cpu->opcodes->dH() & 0b111;
                const uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
@@ -2218,7 +1390,7 @@ InstructionTable::InstructionTable() :
            "BNOT #xx:3 @ERd",
            4,
            2 + 2,
-           [](const Cpu* cpu)
+           [](Cpu* cpu)
            {
                const uint8_t imm = cpu->opcodes->dH() & 0b111;
                const uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
@@ -2235,7 +1407,7 @@ InstructionTable::InstructionTable() :
           "BCLR #xx:3, @ERd",
           4,
           2 + 2,
-          [](const Cpu* cpu)
+          [](Cpu* cpu)
           {
               const uint8_t imm = cpu->opcodes->dH() & 0b111;
               const uint32_t* erd = cpu->registers->Register32(cpu->opcodes->bH());
@@ -2252,7 +1424,7 @@ InstructionTable::InstructionTable() :
            "BLD #xx:3 @aa:8",
            4,
            2 + 1,
-           [](const Cpu* cpu)
+           [](Cpu* cpu)
            {
                if (cpu->opcodes->dH() & 0b1000)
                {
@@ -2264,6 +1436,7 @@ InstructionTable::InstructionTable() :
 
                const uint8_t memoryValue = cpu->ram->ReadByte(address);
                
+               cpu->flags->Resolve();
                cpu->flags->carry = (memoryValue >> imm) & 1;
            }
        )
@@ -2276,7 +1449,7 @@ InstructionTable::InstructionTable() :
             "BSET #xx:3, @aa:8",
             4,
             2 + 2,
-            [](const Cpu* cpu)
+            [](Cpu* cpu)
             {
                 const uint8_t imm = cpu->opcodes->dH() & 0b111;
                 const uint16_t address = cpu->opcodes->b() | 0xFF00;
@@ -2293,7 +1466,7 @@ InstructionTable::InstructionTable() :
            "BCLR #xx:3 @aa:8",
            4,
            2 + 2,
-           [](const Cpu* cpu)
+           [](Cpu* cpu)
            {
                const uint8_t imm = cpu->opcodes->dH() & 0b111;
                const uint16_t address = cpu->opcodes->b() | 0xFF00;
@@ -2302,9 +1475,112 @@ InstructionTable::InstructionTable() :
            }
        )
     );
+
+    BuildDispatchTable();
+}
+
+void InstructionTable::Execute(Cpu* cpu, const Instruction* instruction)
+{
+    if (instruction == nullptr)
+    {
+        throw std::runtime_error(std::format("Instruction at 0x{:04X} with opcode 0x{:04X} 0x{:04X} does not exist", cpu->registers->pc, cpu->opcodes->ab(), cpu->opcodes->cd()));
+    }
+
+    if (instruction->execute != nullptr)
+    {
+        instruction->execute(cpu);
+    }
+
+    cpu->registers->pc += instruction->bytes;
+
+    if (instruction->postExecute != nullptr)
+    {
+        instruction->postExecute(cpu);
+    }
 }
 
-Instruction* InstructionTable::Execute(Cpu* cpu)
+Instruction* InstructionTable::Decode(const Opcode* opcode) const
 {
-    return aH_aL.Execute(cpu);
+    Instruction* instruction = dispatchTable[opcode->ab()];
+    if (instruction != nullptr && instruction->extension != nullptr)
+    {
+        instruction = instruction->extension[opcode->cd() >> 4];
+    }
+
+    return instruction;
+}
+
+void InstructionTable::BuildDispatchTable()
+{
+    // Resolve every encoding once against a scratch opcode. Read handlers on
+    // bytes c and d tell us which first words need an extension table, so the
+    // containers decide that themselves instead of a hardcoded prefix list.
+    Memory scratch(8);
+    Opcode opcode(&scratch);
+
+    bool readC = false;
+    bool readD = false;
+    scratch.OnRead(2, [&readC](uint32_t) { readC = true; });
+    scratch.OnRead(3, [&readD](uint32_t) { readD = true; });
+
+    auto resolve = [&](const uint16_t ab, const uint16_t cd)
+    {
+        scratch.buffer[0] = ab >> 8;
+        scratch.buffer[1] = ab & 0xFF;
+        scratch.buffer[2] = cd >> 8;
+        scratch.buffer[3] = cd & 0xFF;
+        opcode.Update(0);
+
+        return aH_aL.Resolve(&opcode);
+    };
+
+    std::array<Instruction*, EXTENSION_SIZE> instructions;
+    
+    for (uint32_t ab = 0; ab < dispatchTable.size(); ab++)
+    {
+        readC = false;
+        readD = false;
+        dispatchTable[ab] = resolve(ab, 0);
+
+        if (!readC && !readD)
+        {
+            continue;
+        }
+
+        for (uint32_t c = 0; c <= 0xFF; c++)
+        {
+            readD = false;
+            Instruction* instruction = resolve(ab, c << 8);
+
+            for (uint32_t dH = 0; dH <= 0xF; dH++)
+            {
+                instructions[c << 4 | dH] = readD ? resolve(ab, c << 8 | dH << 4) : instruction;
+            }
+        }
+
+        if (std::ranges::all_of(instructions, [&](const Instruction* instruction) { return instruction == instructions[0]; }))
+        {
+            dispatchTable[ab] = instructions[0];
+            continue;
+        }
+
+        const auto existing = std::ranges::find_if(extensionTables, [&](const ExtensionTable* table) { return table->instructions == instructions; });
+
+        ExtensionTable* table;
+        if (existing != extensionTables.end())
+        {
+            table = *existing;
+        }
+        else
+        {
+            table = new ExtensionTable();
+            table->instructions = instructions;
+            table->entry = Instruction(std::format("Extension 0x{:04X}", ab), 0, 0, nullptr);
+            table->entry.extension = table->instructions.data();
+            
+            extensionTables.push_back(table);
+        }
+
+        dispatchTable[ab] = &table->entry;
+    }
 }
@@ -1,4 +1,7 @@
 #pragma once
+#include <array>
+#include <vector>
+
 #include "InstructionContainer.h"
 
 class InstructionTable
@@ -6,10 +9,26 @@ class InstructionTable
 public:
     InstructionTable();
 
-    Instruction* Execute(Cpu* cpu);
+    void Execute(Cpu* cpu, const Instruction* instruction);
+    Instruction* Decode(const Opcode* opcode) const;
 
 private:
+    void BuildDispatchTable();
+    
     InstructionContainer aH_aL;
     InstructionContainer aHaL_bH;
     InstructionContainer aHaLbHbLcH_cL;
+
+    static constexpr size_t EXTENSION_SIZE = 0x1000;
+
+    struct ExtensionTable
+    {
+        Instruction entry;
+        std::array<Instruction*, EXTENSION_SIZE> instructions;
+    };
+
+    // Indexed by the first opcode word (ab). Prefixed forms point at an entry
+    // whose extension table is indexed by the following byte and nibble.
+    std::array<Instruction*, 0x10000> dispatchTable{};
+    std::vector<ExtensionTable*> extensionTables;
 };
@@ -0,0 +1,284 @@
+#include "Recompiler.h"
+#if defined(__x86_64__)
+
+#include <sys/mman.h>
+
+#include "../Cpu.h"
+
+namespace
+{
+    // Offsets into the Registers buffer, matching Register8/16/32.
+    uint8_t Offset8(const uint8_t control) { return (control & 0b111) * 4 + (~(control >> 3) & 1); }
+    uint8_t Offset16(const uint8_t control) { return (control & 0b111) * 4 + (control >> 3 & 1) * 2; }
+    uint8_t Offset32(const uint8_t control) { return (control & 0b111) * 4; }
+
+    // What Flags::Mov leaves in N and Z for a value known up front.
+    uint8_t ConstantMovFlags(const uint32_t value, const size_t bits)
+    {
+        uint8_t flags = 0;
+        if (value & Flags::NegativeMask(bits)) flags |= 1 << 3;
+        if (value == 0) flags |= 1 << 2;
+        return flags;
+    }
+
+    // Worst case bytes for one op plus its exit, and for the prologue.
+    constexpr size_t MAX_OP_SIZE = 96;
+    constexpr size_t MAX_PROLOGUE_SIZE = 64;
+}
+
+Recompiler::Recompiler(Cpu* cpu, const Fallback fallback) : cpu(cpu), fallback(fallback)
+{
+    void* memory = mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory != MAP_FAILED)
+    {
+        code = static_cast<uint8_t*>(memory);
+    }
+}
+
+bool Recompiler::IsNative(const BlockOp& op)
+{
+    const uint8_t a = op.bytes[0];
+    const uint8_t b = op.bytes[1];
+
+    switch (a)
+    {
+    case 0x00: return b == 0x00; // NOP
+    case 0x0C: // MOV.B Rs, Rd
+    case 0x0D: // MOV.W Rs, Rd
+    case 0x14: // OR.B Rs, Rd
+    case 0x15: // XOR.B Rs, Rd
+    case 0x16: // AND.B Rs, Rd
+    case 0x64: // OR.W Rs, Rd
+    case 0x65: // XOR.W Rs, Rd
+    case 0x66: // AND.W Rs, Rd
+        return true;
+    case 0x0F: return b >> 4 >= 0x8; // MOV.L ERs, ERd
+    case 0x0B: return b >> 4 == 0x0 || b >> 4 == 0x8 || b >> 4 == 0x9; // ADDS #1/#2/#4
+    case 0x1B: return b >> 4 == 0x8 || b >> 4 == 0x9; // SUBS #2/#4
+    case 0x79: return b >> 4 == 0x0; // MOV.W #xx:16, Rd
+    case 0x7A: return b >> 4 == 0x0; // MOV.L #xx:32, ERd
+    default:
+        break;
+    }
+
+    // MOV.B/OR.B/XOR.B/AND.B #xx:8, Rd
+    if (a >> 4 >= 0xC)
+    {
+        return true;
+    }
+
+    // BRA and the Bcc d:8 forms the interpreter implements.
+    return a >> 4 == 0x4 && a != 0x41 && a != 0x48 && a != 0x49;
+}
+
+void Recompiler::EmitOp(X86Emitter& emitter, const BlockOp& op) const
+{
+    const uint8_t a = op.bytes[0];
+    const uint8_t b = op.bytes[1];
+    const uint8_t bH = b >> 4;
+    const uint8_t bL = b & 0xF;
+    const uint16_t next = op.address + op.instruction->bytes;
+
+    switch (a)
+    {
+    case 0x00:
+        break;
+    case 0x0C:
+        emitter.LoadRegister(8, Offset8(bH));
+        emitter.StoreRegister(8, Offset8(bL));
+        emitter.MovFlags(8);
+        break;
+    case 0x0D:
+        emitter.LoadRegister(16, Offset16(bH));
+        emitter.StoreRegister(16, Offset16(bL));
+        emitter.MovFlags(16);
+        break;
+    case 0x0F:
+        emitter.LoadRegister(32, Offset32(bH));
+        emitter.StoreRegister(32, Offset32(bL));
+        emitter.MovFlags(32);
+        break;
+    case 0x14:
+    case 0x15:
+    case 0x16:
+    case 0x64:
+    case 0x65:
+    case 0x66:
+    {
+        const size_t bits = a >> 4 == 0x1 ? 8 : 16;
+        const uint8_t source = bits == 8 ? Offset8(bH) : Offset16(bH);
+        const uint8_t destination = bits == 8 ? Offset8(bL) : Offset16(bL);
+        const X86Emitter::Logic logic = (a & 0xF) == 0x4 ? X86Emitter::Or : (a & 0xF) == 0x5 ? X86Emitter::Xor : X86Emitter::And;
+
+        emitter.LoadRegister(bits, destination);
+        emitter.LogicRegister(logic, bits, source);
+        emitter.StoreRegister(bits, destination);
+        emitter.MovFlags(bits);
+        break;
+    }
+    case 0x0B:
+        emitter.AddRegisterImmediate(Offset32(bL), bH == 0x0 ? 1 : bH == 0x8 ? 2 : 4);
+        break;
+    case 0x1B:
+        emitter.AddRegisterImmediate(Offset32(bL), bH == 0x8 ? -2 : -4);
+        break;
+    case 0x79:
+    {
+        const uint16_t imm = op.bytes[2] << 8 | op.bytes[3];
+        emitter.StoreRegisterImmediate(16, Offset16(bL), imm);
+        emitter.MovFlagsConstant(ConstantMovFlags(imm, 16));
+        break;
+    }
+    case 0x7A:
+    {
+        const uint32_t imm = op.bytes[2] << 24 | op.bytes[3] << 16 | op.bytes[4] << 8 | op.bytes[5];
+        emitter.StoreRegisterImmediate(32, Offset32(bL), imm);
+        emitter.MovFlagsConstant(ConstantMovFlags(imm, 32));
+        break;
+    }
+    default:
+        if (a >> 4 == 0xF)
+        {
+            emitter.StoreRegisterImmediate(8, Offset8(a & 0xF), b);
+            emitter.MovFlagsConstant(ConstantMovFlags(b, 8));
+        }
+        else if (a >> 4 >= 0xC)
+        {
+            const X86Emitter::Logic logic = a >> 4 == 0xC ? X86Emitter::Or : a >> 4 == 0xD ? X86Emitter::Xor : X86Emitter::And;
+
+            emitter.LoadRegister(8, Offset8(a & 0xF));
+            emitter.LogicImmediate(logic, b);
+            emitter.StoreRegister(8, Offset8(a & 0xF));
+            emitter.MovFlags(8);
+        }
+        else
+        {
+            const uint16_t target = next + static_cast<int8_t>(b);
+            if (a == 0x40)
+            {
+                emitter.StorePc(target);
+                return;
+            }
+
+            // The test sets ZF exactly when the even condition (HI, CC, NE,
+            // PL, GE, GT) holds, the odd ones are its negation.
+            emitter.LoadCcr();
+            switch (a & 0xE)
+            {
+            case 0x2: emitter.Bytes({0xA8, 0x05}); break; // HI/LS: test al, C | Z
+            case 0x4: emitter.Bytes({0xA8, 0x01}); break; // CC/CS: test al, C
+            case 0x6: emitter.Bytes({0xA8, 0x04}); break; // NE/EQ: test al, Z
+            case 0xA: emitter.Bytes({0xA8, 0x08}); break; // PL/MI: test al, N
+            case 0xC: // GE/LT: N ^ V
+                emitter.Bytes({0x89, 0xC1, 0xC1, 0xE9, 0x02, 0x31, 0xC1, 0xF6, 0xC1, 0x02});
+                break;
+            case 0xE: // GT/LE: Z | (N ^ V)
+                emitter.Bytes({0x89, 0xC1, 0xC1, 0xE9, 0x02, 0x31, 0xC1, 0x80, 0xE1, 0x02});
+                emitter.Bytes({0x88, 0xC2, 0x80, 0xE2, 0x04, 0x08, 0xD1, 0x84, 0xC9});
+                break;
+            }
+
+            emitter.StorePc(next);
+            uint8_t* skip = emitter.JumpShort(a & 1 ? X86Emitter::JZ : X86Emitter::JNZ);
+            emitter.StorePc(target);
+            emitter.PatchShort(skip);
+            return;
+        }
+        break;
+    }
+
+    emitter.StorePc(next);
+}
+
+bool Recompiler::HasRoom(const size_t ops) const
+{
+    return used + MAX_PROLOGUE_SIZE + (ops + 1) * MAX_OP_SIZE <= CODE_SIZE;
+}
+
+CompiledBlock Recompiler::Compile(const Block* block)
+{
+    if (!HasRoom(block->ops.size()))
+    {
+        return nullptr;
+    }
+
+    X86Emitter emitter(code + used);
+    emitter.BlockPrologue(cpu->registers->buffer, &cpu->flags->ccr, &cpu->registers->pc);
+
+    size_t cycles = 0;
+    size_t nativeCount = 0;
+
+    // Cycle and instruction counts are known at every exit, so each exit
+    // just adds its own totals.
+    auto exit = [&]()
+    {
+        if (nativeCount != 0)
+        {
+            emitter.AddToCounter(&cpu->instructionCount, nativeCount);
+        }
+
+        emitter.ReturnValue(cycles);
+        emitter.BlockEpilogue();
+    };
+
+    for (size_t index = 0; index < block->ops.size(); index++)
+    {
+        const BlockOp& op = block->ops[index];
+        cycles += op.instruction->cycles;
+
+        uint8_t* resume;
+        if (IsNative(op))
+        {
+            EmitOp(emitter, op);
+            nativeCount++;
+
+            if (op.bytes[0] >> 4 != 0x4)
+            {
+                continue;
+            }
+
+            emitter.ComparePc(op.address + op.instruction->bytes);
+            resume = emitter.JumpShort(X86Emitter::JZ);
+        }
+        else
+        {
+            emitter.CallFallback(reinterpret_cast<const void*>(fallback), index * sizeof(BlockOp));
+            emitter.Bytes({0x84, 0xC0}); // test al, al
+            resume = emitter.JumpShort(X86Emitter::JNZ);
+        }
+
+        exit();
+        emitter.PatchShort(resume);
+    }
+
+    exit();
+
+    const auto compiled = reinterpret_cast<CompiledBlock>(code + used);
+    used += emitter.Size();
+
+    return compiled;
+}
+
+CompiledOp Recompiler::CompileOp(const BlockOp& op)
+{
+    if (!HasRoom(1))
+    {
+        return nullptr;
+    }
+
+    X86Emitter emitter(code + used);
+    emitter.OpPrologue();
+    EmitOp(emitter, op);
+    emitter.OpEpilogue();
+
+    const auto compiled = reinterpret_cast<CompiledOp>(code + used);
+    used += emitter.Size();
+
+    return compiled;
+}
+
+void Recompiler::Reset()
+{
+    used = 0;
+}
+#endif
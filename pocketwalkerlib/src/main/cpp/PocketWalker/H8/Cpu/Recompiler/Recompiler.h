@@ -0,0 +1,50 @@
+#pragma once
+#if defined(__x86_64__)
+#include <cstdint>
+
+#include "X86Emitter.h"
+
+class Cpu;
+struct Block;
+struct BlockOp;
+
+// Runs a whole block, returns the cycles it took.
+using CompiledBlock = size_t (*)(Cpu* cpu, const BlockOp* ops);
+// Runs a single native op against the given registers buffer, ccr and pc.
+using CompiledOp = void (*)(uint8_t* registers, uint8_t* ccr, uint16_t* pc);
+
+// x86-64 backend for the block cache. Register moves, logic ops, ADDS/SUBS and
+// 8-bit branches are emitted as native code, everything else (memory access,
+// arithmetic, BILD/BIST...) calls back into the interpreter handler for that
+// op. Register and flag state stays in the existing Registers buffer and ccr
+// byte so both paths can be mixed freely.
+class Recompiler
+{
+public:
+    using Fallback = bool (*)(Cpu* cpu, const BlockOp* op);
+
+    Recompiler(Cpu* cpu, Fallback fallback);
+
+    bool Available() const { return code != nullptr; }
+
+    // nullptr when the code cache is full, call Reset and try again.
+    CompiledBlock Compile(const Block* block);
+    CompiledOp CompileOp(const BlockOp& op);
+
+    static bool IsNative(const BlockOp& op);
+
+    void Reset();
+
+    static constexpr size_t CODE_SIZE = 8 * 1024 * 1024;
+
+private:
+    void EmitOp(X86Emitter& emitter, const BlockOp& op) const;
+    bool HasRoom(size_t ops) const;
+
+    Cpu* cpu;
+    Fallback fallback;
+
+    uint8_t* code = nullptr;
+    size_t used = 0;
+};
+#endif
@@ -0,0 +1,191 @@
+#pragma once
+#if defined(__x86_64__)
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+// Just the handful of x86-64 encodings the recompiler needs. Register use is
+// fixed by the recompiler: rbx holds the Registers buffer, r12 points at the
+// ccr, r13 at the Cpu, r14 at pc and r15 at the block's ops. rax, rcx and rdx
+// are scratch.
+class X86Emitter
+{
+public:
+    X86Emitter(uint8_t* code) : code(code), cursor(code) { }
+
+    uint8_t* Position() const { return cursor; }
+    size_t Size() const { return cursor - code; }
+
+    void Bytes(std::initializer_list<uint8_t> bytes)
+    {
+        for (const uint8_t byte : bytes)
+        {
+            *cursor++ = byte;
+        }
+    }
+
+    void Imm8(const uint8_t value) { *cursor++ = value; }
+    void Imm16(const uint16_t value) { std::memcpy(cursor, &value, 2); cursor += 2; }
+    void Imm32(const uint32_t value) { std::memcpy(cursor, &value, 4); cursor += 4; }
+    void Imm64(const uint64_t value) { std::memcpy(cursor, &value, 8); cursor += 8; }
+
+    void BlockPrologue(const void* registers, const void* ccr, const void* pc)
+    {
+        Bytes({0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57}); // push rbx, r12-r15
+        Bytes({0x49, 0x89, 0xFD}); // mov r13, rdi
+        Bytes({0x49, 0x89, 0xF7}); // mov r15, rsi
+        Bytes({0x48, 0xBB}); Imm64(reinterpret_cast<uint64_t>(registers)); // mov rbx, imm64
+        Bytes({0x49, 0xBC}); Imm64(reinterpret_cast<uint64_t>(ccr)); // mov r12, imm64
+        Bytes({0x49, 0xBE}); Imm64(reinterpret_cast<uint64_t>(pc)); // mov r14, imm64
+    }
+
+    void BlockEpilogue()
+    {
+        Bytes({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B}); // pop r15-r12, rbx
+        Bytes({0xC3}); // ret
+    }
+
+    // (registers, ccr, pc) come in as arguments instead, so one op can be run
+    // against scratch state.
+    void OpPrologue()
+    {
+        Bytes({0x53, 0x41, 0x54, 0x41, 0x56}); // push rbx, r12, r14
+        Bytes({0x48, 0x89, 0xFB}); // mov rbx, rdi
+        Bytes({0x49, 0x89, 0xF4}); // mov r12, rsi
+        Bytes({0x49, 0x89, 0xD6}); // mov r14, rdx
+    }
+
+    void OpEpilogue()
+    {
+        Bytes({0x41, 0x5E, 0x41, 0x5C, 0x5B, 0xC3}); // pop r14, r12, rbx; ret
+    }
+
+    // Loads and stores of a register slot at [rbx + offset].
+    void LoadRegister(const size_t bits, const uint8_t offset)
+    {
+        if (bits == 8) Bytes({0x0F, 0xB6, 0x43, offset}); // movzx eax, byte
+        else if (bits == 16) Bytes({0x0F, 0xB7, 0x43, offset}); // movzx eax, word
+        else Bytes({0x8B, 0x43, offset}); // mov eax, dword
+    }
+
+    void StoreRegister(const size_t bits, const uint8_t offset)
+    {
+        if (bits == 8) Bytes({0x88, 0x43, offset}); // mov byte, al
+        else if (bits == 16) Bytes({0x66, 0x89, 0x43, offset}); // mov word, ax
+        else Bytes({0x89, 0x43, offset}); // mov dword, eax
+    }
+
+    void StoreRegisterImmediate(const size_t bits, const uint8_t offset, const uint32_t value)
+    {
+        if (bits == 8) { Bytes({0xC6, 0x43, offset}); Imm8(value); }
+        else if (bits == 16) { Bytes({0x66, 0xC7, 0x43, offset}); Imm16(value); }
+        else { Bytes({0xC7, 0x43, offset}); Imm32(value); }
+    }
+
+    enum Logic : uint8_t
+    {
+        Or = 0x0A,
+        And = 0x22,
+        Xor = 0x32
+    };
+
+    // eax op= [rbx + offset]
+    void LogicRegister(const Logic logic, const size_t bits, const uint8_t offset)
+    {
+        if (bits == 16) Imm8(0x66);
+        Bytes({static_cast<uint8_t>(bits == 8 ? logic : logic + 1), 0x43, offset});
+    }
+
+    // al op= imm8
+    void LogicImmediate(const Logic logic, const uint8_t value)
+    {
+        Bytes({static_cast<uint8_t>(logic + 2), value});
+    }
+
+    void AddRegisterImmediate(const uint8_t offset, const int8_t value)
+    {
+        Bytes({0x83, 0x43, offset, static_cast<uint8_t>(value)}); // add dword [rbx + offset], imm8
+    }
+
+    // N and Z from eax at the given width, V cleared, the rest of the ccr kept.
+    void MovFlags(const size_t bits)
+    {
+        if (bits == 8) Bytes({0x84, 0xC0}); // test al, al
+        else if (bits == 16) Bytes({0x66, 0x85, 0xC0}); // test ax, ax
+        else Bytes({0x85, 0xC0}); // test eax, eax
+
+        Bytes({0x0F, 0x98, 0xC1}); // sets cl
+        Bytes({0x0F, 0x94, 0xC2}); // setz dl
+        Bytes({0xC0, 0xE1, 0x03}); // shl cl, 3
+        Bytes({0xC0, 0xE2, 0x02}); // shl dl, 2
+        Bytes({0x08, 0xD1}); // or cl, dl
+        Bytes({0x41, 0x80, 0x24, 0x24, 0xF1}); // and byte [r12], ~(N | Z | V)
+        Bytes({0x41, 0x08, 0x0C, 0x24}); // or byte [r12], cl
+    }
+
+    // Same, with the flags already known at compile time.
+    void MovFlagsConstant(const uint8_t flags)
+    {
+        Bytes({0x41, 0x80, 0x24, 0x24, 0xF1}); // and byte [r12], ~(N | Z | V)
+        if (flags != 0)
+        {
+            Bytes({0x41, 0x80, 0x0C, 0x24, flags}); // or byte [r12], imm8
+        }
+    }
+
+    void LoadCcr()
+    {
+        Bytes({0x41, 0x8A, 0x04, 0x24}); // mov al, [r12]
+    }
+
+    void StorePc(const uint16_t value)
+    {
+        Bytes({0x66, 0x41, 0xC7, 0x06}); Imm16(value); // mov word [r14], imm16
+    }
+
+    void ComparePc(const uint16_t value)
+    {
+        Bytes({0x66, 0x41, 0x81, 0x3E}); Imm16(value); // cmp word [r14], imm16
+    }
+
+    // Calls target(r13, r15 + opOffset), the bool result ends up in al.
+    void CallFallback(const void* target, const uint32_t opOffset)
+    {
+        Bytes({0x4C, 0x89, 0xEF}); // mov rdi, r13
+        Bytes({0x49, 0x8D, 0xB7}); Imm32(opOffset); // lea rsi, [r15 + disp32]
+        Bytes({0x48, 0xB8}); Imm64(reinterpret_cast<uint64_t>(target)); // mov rax, imm64
+        Bytes({0xFF, 0xD0}); // call rax
+    }
+
+    void AddToCounter(const void* counter, const uint32_t value)
+    {
+        Bytes({0x48, 0xB8}); Imm64(reinterpret_cast<uint64_t>(counter)); // mov rax, imm64
+        Bytes({0x48, 0x81, 0x00}); Imm32(value); // add qword [rax], imm32
+    }
+
+    void ReturnValue(const uint32_t value)
+    {
+        Imm8(0xB8); Imm32(value); // mov eax, imm32
+    }
+
+    // Short forward jumps, patched once the target is known.
+    uint8_t* JumpShort(const uint8_t opcode)
+    {
+        Bytes({opcode, 0x00});
+        return cursor - 1;
+    }
+
+    void PatchShort(uint8_t* displacement) const
+    {
+        *displacement = static_cast<uint8_t>(cursor - displacement - 1);
+    }
+
+    static constexpr uint8_t JZ = 0x74;
+    static constexpr uint8_t JNZ = 0x75;
+    static constexpr uint8_t JMP = 0xEB;
+
+private:
+    uint8_t* code;
+    uint8_t* cursor;
+};
+#endif
@@ -1,12 +1,16 @@
 #include "H8300H.h"
 
+#include <algorithm>
 #include <thread>
 
+#include "Hle/Hle.h"
 #include "IO/IOComponent.h"
+#include "Rewind/Rewind.h"
+#include "../Utilities/StateSerializer.h"
 
-H8300H::H8300H(uint8_t* ramBuffer): board(new Board(ramBuffer))
+H8300H::H8300H(uint8_t* ramBuffer, const ExecutionMode executionMode): board(new Board(ramBuffer, executionMode))
 {
-    
+    hle = new Hle(this, board->cpu, board->ram, Board::RAM_SIZE);
 }
 
 void H8300H::StartAsync()
@@ -23,6 +27,18 @@ void H8300H::StartSync()
     EmulatorLoop();
 }
 
+void H8300H::RunUntil(const uint64_t cycles)
+{
+    fastForwardLimit = cycles;
+
+    while (elapsedCycles < cycles)
+    {
+        Step();
+    }
+
+    fastForwardLimit = UINT64_MAX;
+}
+
 void H8300H::Stop()
 {
     isRunning = false;
@@ -31,6 +47,11 @@ void H8300H::Stop()
 void H8300H::Pause()
 {
     isPaused = true;
+
+    if (std::this_thread::get_id() != loopThread)
+    {
+        isParked.wait(false);
+    }
 }
 
 void H8300H::Resume()
@@ -49,15 +70,19 @@ void H8300H::EmulatorLoop()
         auto startTime = std::chrono::high_resolution_clock::now();
 
         while (isRunning) {
-            Step();
-            instructionCount++;
-
+            // Checked before stepping, so a Pause that finds isParked still
+            // set from the last pause is always seen here first.
             if (isPaused) {
+                isParked = true;
+                isParked.notify_all();
+
                 auto pauseStart = std::chrono::high_resolution_clock::now();
                 while (isPaused && isRunning) {
                     std::this_thread::sleep_for(std::chrono::milliseconds(10));
                 }
                 auto pauseEnd = std::chrono::high_resolution_clock::now();
+
+                isParked = false;
         
                 auto pausedDuration = pauseEnd - pauseStart;
                 startTime += pausedDuration;
@@ -65,7 +90,23 @@ void H8300H::EmulatorLoop()
                 continue;
             }
 
-            if (instructionCount >= INSTRUCTIONS_PER_TIMING_CHECK) {
+            // Whichever way exceptions are handled, a failed HLE check only
+            // pauses, with the machine as the firmware left it.
+            try
+            {
+                Step();
+            }
+            catch (const HleMismatch& e)
+            {
+                std::println("\033[31m{}\033[0m", e.what());
+                Pause();
+            }
+
+            instructionCount++;
+
+            // A fast-forward can cover a lot of cycles in one step, so let the
+            // host catch up straight away rather than after the next batch.
+            if (instructionCount >= INSTRUCTIONS_PER_TIMING_CHECK || board->cpu->sleeping) {
                 auto currentTime = std::chrono::high_resolution_clock::now();
                 std::chrono::duration<double> elapsedTime = currentTime - startTime;
 
@@ -80,6 +121,9 @@ void H8300H::EmulatorLoop()
         }
     };
 
+    loopThread = std::this_thread::get_id();
+    isParked = false;
+
     if (isExceptionHandling)
     {
         try
@@ -96,29 +140,152 @@ void H8300H::EmulatorLoop()
     {
         loop();
     }
+
+    // Nothing steps any more, let a waiting Pause go.
+    loopThread = std::thread::id();
+    isParked = true;
+    isParked.notify_all();
 }
 
-uint8_t H8300H::Step()
+size_t H8300H::Step()
 {
-    const uint8_t cpuCycles = board->cpu->Step();
-    for (auto i = 0; i < cpuCycles; i++)
+    const size_t cpuCycles = board->cpu->Step();
+
+    elapsedCycles += cpuCycles;
+    board->scheduler->Advance(elapsedCycles);
+
+    // Before dispatching, so a call that just returned is compared before an
+    // interrupt held back during it runs.
+    if (hle->IsVerifying())
     {
-        elapsedCycles++;
+        hle->CheckVerification();
+    }
 
-        Tick(elapsedCycles);
+    DispatchInterrupts();
+
+    if (board->cpu->sleeping)
+    {
+        return cpuCycles + FastForward();
     }
 
     return cpuCycles;
 }
 
-
-void H8300H::Tick(uint64_t cycles)
+size_t H8300H::FastForward()
 {
-    board->Tick(cycles);
+    // A hook on the sleeping pc still runs every cycle, leave those alone.
+    if (board->cpu->HasAddressHandler(board->cpu->registers->pc))
+    {
+        return 0;
+    }
 
-    if (cycles % 64 == 0 && !board->cpu->flags->interrupt)
+    // Nothing changes on a sleeping CPU between two scheduled events, so go
+    // from one deadline to the next until one of them (usually the RTC or a
+    // timer raising a flag) wakes it up.
+    const uint64_t start = elapsedCycles;
+    const uint64_t limit = std::min(start + FAST_FORWARD_CYCLES, fastForwardLimit);
+
+    while (board->cpu->sleeping && elapsedCycles < limit)
+    {
+        elapsedCycles = std::min(board->scheduler->NextDeadline(), limit);
+        board->scheduler->Advance(elapsedCycles);
+        DispatchInterrupts();
+    }
+
+    return elapsedCycles - start;
+}
+
+void H8300H::DispatchInterrupts() const
+{
+    // Held back while the firmware replays a verified HLE call. The native
+    // run took no time for them to happen in, and handlers writing RAM would
+    // look like mismatches.
+    if (board->cpu->interrupts->Pending() && !board->cpu->flags->interrupt && !hle->IsVerifying())
     {
         board->cpu->UpdateInterrupts();
     }
 }
 
+std::vector<uint8_t> H8300H::SaveState() const
+{
+    StateWriter writer(Board::RAM_SIZE * 2 + 0x4000);
+    SaveState(writer);
+
+    return std::move(writer.data);
+}
+
+void H8300H::SaveState(StateWriter& writer) const
+{
+    writer.Write(STATE_MAGIC);
+    writer.Write(STATE_VERSION);
+    writer.Write(elapsedCycles);
+
+    board->SaveState(writer);
+    SaveComponents(writer);
+}
+
+void H8300H::LoadState(const uint8_t* data, const size_t size)
+{
+    StateReader reader(data, size);
+
+    if (reader.Read<uint32_t>() != STATE_MAGIC)
+    {
+        throw std::runtime_error("Not a save state.");
+    }
+
+    if (const uint32_t version = reader.Read<uint32_t>(); version != STATE_VERSION)
+    {
+        throw std::runtime_error(std::format("Unsupported save state version {}, expected {}", version, STATE_VERSION));
+    }
+
+    // A blob that runs short part way through would leave a half restored
+    // machine, so put the current one back before rethrowing.
+    const std::vector<uint8_t> previous = SaveState();
+    try
+    {
+        Restore(reader);
+    }
+    catch (const std::exception&)
+    {
+        StateReader fallback(previous.data(), previous.size());
+        fallback.Read<uint32_t>();
+        fallback.Read<uint32_t>();
+        Restore(fallback);
+        throw;
+    }
+}
+
+void H8300H::Restore(StateReader& reader)
+{
+    reader.Read(elapsedCycles);
+
+    board->LoadState(reader);
+    LoadComponents(reader);
+
+    board->scheduler->Restart(elapsedCycles);
+}
+
+void H8300H::EnableRewind(const uint32_t intervalMs, const size_t budget)
+{
+    rewind = new Rewind(this, budget);
+
+    board->scheduler->AddPeriodic(static_cast<uint64_t>(Cpu::TICKS) * intervalMs / 1000, [this]()
+    {
+        rewind->Capture();
+    });
+}
+
+bool H8300H::RewindStep()
+{
+    return rewind != nullptr && rewind->StepBack();
+}
+
+bool H8300H::SetHleEnabled(const std::string& name, const bool enabled) const
+{
+    return hle->SetEnabled(name, enabled);
+}
+
+bool H8300H::SetHleVerifying(const std::string& name, const bool verifying) const
+{
+    return hle->SetVerifying(name, verifying);
+}
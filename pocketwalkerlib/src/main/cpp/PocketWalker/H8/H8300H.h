@@ -1,25 +1,73 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "Board/Board.h"
 
+class Rewind;
+class Hle;
+
 class H8300H
 {
 public:
-    H8300H(uint8_t* ramBuffer);
+    H8300H(uint8_t* ramBuffer, ExecutionMode executionMode = ExecutionMode::Interpreter);
 
     void StartAsync();
     void StartSync();
     void Stop();
+
+    // Pause returns once the emulator loop has stopped stepping, so the
+    // machine can be saved or loaded from another thread until Resume. From
+    // the loop's own thread it returns straight away and the loop stops after
+    // the current step.
     void Pause();
     void Resume();
     
+    // Runs on the calling thread until at least cycles have elapsed, with no
+    // real time throttling, so several instances can be driven in lockstep.
+    // Not for an instance that was started.
+    void RunUntil(uint64_t cycles);
+
     bool IsRunning() const { return isRunning; }
     bool IsPaused() const { return isPaused; }
     
     void SetExceptionHandling(const bool value) { isExceptionHandling = value; }
 
+    // Whole machine snapshot. Only call these while the emulator is paused or
+    // from its own thread. LoadState throws if the blob is not a save state
+    // of this version, and leaves the running machine as it was.
+    std::vector<uint8_t> SaveState() const;
+    void SaveState(StateWriter& writer) const;
+    void LoadState(const uint8_t* data, size_t size);
+
+    // Captures a rewind frame every intervalMs of emulated time, keeping at
+    // most budget bytes of them. Call before the emulator is started.
+    void EnableRewind(uint32_t intervalMs, size_t budget);
+
+    // Same threading rules as LoadState. False when rewind is off or there is
+    // nothing older to go back to.
+    bool RewindStep();
+
+    // Turns a routine registered with hle on or off, or has its calls checked
+    // against the firmware. False if there is no routine by that name. A
+    // failed check pauses a started emulator and throws out of RunUntil.
+    bool SetHleEnabled(const std::string& name, bool enabled) const;
+    bool SetHleVerifying(const std::string& name, bool verifying) const;
+
+    // Replaces the wall clock the RTC reads, e.g. with a fixed time so runs
+    // can be repeated. Call before the emulator is started.
+    void SetClock(std::function<std::time_t()> clock) const { board->rtc->clock = std::move(clock); }
+
+    uint64_t GetElapsedCycles() const { return elapsedCycles; }
+
+    static constexpr uint32_t STATE_MAGIC = 0x54535750; // "PWST"
+    static constexpr uint32_t STATE_VERSION = 2;
+
 
 protected:
     
@@ -29,19 +77,39 @@ protected:
         board->ssu->RegisterIOPeripheral(port, pin, component);
     }
 
-    Board* board;
+    // Devices outside the board, saved after it.
+    virtual void SaveComponents(StateWriter& /*writer*/) const { }
+    virtual void LoadComponents(StateReader& /*reader*/) { }
 
-    virtual void Tick(uint64_t cycles);
+    Board* board;
+    Hle* hle;
 
 private:
     void EmulatorLoop();
-    uint8_t Step();
+    size_t Step();
+    size_t FastForward();
+    void DispatchInterrupts() const;
+    void Restore(StateReader& reader);
+
+    // Upper bound on one sleep fast-forward, roughly a millisecond, so button
+    // and IR input from other threads is still picked up promptly.
+    static constexpr uint64_t FAST_FORWARD_CYCLES = Cpu::TICKS / 1000;
 
     std::thread emulatorThread;
     
     bool isExceptionHandling = true;
-    bool isRunning = false;
-    bool isPaused = false;
+    std::atomic<bool> isRunning = false;
+    std::atomic<bool> isPaused = false;
+
+    // Whether the loop is guaranteed not to step until isPaused is cleared.
+    // Also true while no loop is running at all.
+    std::atomic<bool> isParked = true;
+    std::atomic<std::thread::id> loopThread;
 
     uint64_t elapsedCycles = 0;
+
+    // Where RunUntil wants to stop, a fast-forward doesn't go past it.
+    uint64_t fastForwardLimit = UINT64_MAX;
+
+    Rewind* rewind = nullptr;
 };
\ No newline at end of file
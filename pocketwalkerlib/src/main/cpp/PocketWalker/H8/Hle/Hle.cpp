@@ -0,0 +1,255 @@
+#include "Hle.h"
+
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include "../H8300H.h"
+#include "../Memory/Memory.h"
+
+Hle::Hle(H8300H* emulator, Cpu* cpu, Memory* ram, const size_t ramSize) : emulator(emulator), cpu(cpu)
+{
+    Watch(ram, ramSize);
+}
+
+void Hle::Add(const HleRoutine& routine)
+{
+    HleRoutine* added = new HleRoutine(routine);
+    routines.push_back(added);
+
+    cpu->OnAddress(added->entry, [this, added](Cpu*)
+    {
+        return Call(*added);
+    });
+}
+
+bool Hle::SetEnabled(const std::string& name, const bool enabled)
+{
+    HleRoutine* routine = const_cast<HleRoutine*>(Find(name));
+    if (routine == nullptr)
+    {
+        return false;
+    }
+
+    routine->isEnabled = enabled;
+    return true;
+}
+
+bool Hle::SetVerifying(const std::string& name, const bool verifying)
+{
+    HleRoutine* routine = const_cast<HleRoutine*>(Find(name));
+    if (routine == nullptr)
+    {
+        return false;
+    }
+
+    routine->isVerifying = verifying;
+    return true;
+}
+
+const HleRoutine* Hle::Find(const std::string& name) const
+{
+    for (const HleRoutine* routine : routines)
+    {
+        if (routine->name == name)
+        {
+            return routine;
+        }
+    }
+
+    return nullptr;
+}
+
+void Hle::Watch(Memory* memory, const size_t size)
+{
+    watched.push_back({ memory, size });
+}
+
+PCHandlerResult Hle::Call(HleRoutine& routine)
+{
+    if (routine.observe)
+    {
+        routine.observe(cpu);
+    }
+
+    // Calls made while a verification is running, nested ones included, are
+    // the firmware's.
+    if (!routine.isEnabled || IsVerifying())
+    {
+        return Continue;
+    }
+
+    if (routine.isVerifying || routine.isVerifyOnly)
+    {
+        return Verify(routine);
+    }
+
+    const size_t cycles = routine.cost(cpu);
+    if (!routine.run(cpu))
+    {
+        return Continue;
+    }
+
+    Return(routine);
+
+    // The skipped step is already worth a cycle.
+    cpu->AddCycles(cycles > 0 ? cycles - 1 : 0);
+
+    return SkipInstruction;
+}
+
+PCHandlerResult Hle::Verify(HleRoutine& routine)
+{
+    const Outcome entry = Capture();
+    const size_t cycles = routine.cost(cpu);
+
+    if (!routine.run(cpu))
+    {
+        return Continue;
+    }
+
+    Return(routine);
+    Outcome expected = Capture();
+
+    // Back to the entry, for the firmware to do it again.
+    Restore(entry);
+
+    pending.routine = &routine;
+    pending.returnPc = expected.pc;
+    pending.returnSp = *cpu->registers->sp + (routine.returnConvention == HleReturn::Rts ? 2 : 0);
+    pending.startCycles = emulator->GetElapsedCycles();
+    pending.expected = std::move(expected);
+
+    routine.verifiedCost = cycles;
+
+    return Continue;
+}
+
+void Hle::CheckVerification()
+{
+    if (cpu->registers->pc != pending.returnPc || *cpu->registers->sp != pending.returnSp)
+    {
+        if (emulator->GetElapsedCycles() - pending.startCycles > VERIFY_CYCLE_LIMIT)
+        {
+            const HleRoutine& routine = *std::exchange(pending.routine, nullptr);
+            throw HleMismatch(std::format("HLE {} at 0x{:04X} did not return within {} cycles with interrupts held off", routine.name, routine.entry, VERIFY_CYCLE_LIMIT));
+        }
+
+        return;
+    }
+
+    HleRoutine& routine = *pending.routine;
+    pending.routine = nullptr;
+
+    routine.interpretedCycles = emulator->GetElapsedCycles() - pending.startCycles;
+    Compare(routine, pending.expected, Capture());
+}
+
+void Hle::Return(const HleRoutine& routine) const
+{
+    if (routine.returnConvention == HleReturn::Rts)
+    {
+        cpu->registers->pc = cpu->registers->PopStack();
+    }
+    else
+    {
+        cpu->registers->pc = routine.entry + routine.skipBytes;
+    }
+}
+
+Hle::Outcome Hle::Capture() const
+{
+    cpu->flags->Resolve();
+
+    Outcome outcome{};
+    std::memcpy(outcome.registers, cpu->registers->buffer, sizeof(outcome.registers));
+    outcome.ccr = cpu->flags->ccr;
+    outcome.pc = cpu->registers->pc;
+
+    for (const Watched& memory : watched)
+    {
+        outcome.memories.emplace_back(memory.memory->buffer, memory.memory->buffer + memory.size);
+    }
+
+    return outcome;
+}
+
+void Hle::Restore(const Outcome& outcome) const
+{
+    std::memcpy(cpu->registers->buffer, outcome.registers, sizeof(outcome.registers));
+    cpu->flags->Discard();
+    cpu->flags->ccr = outcome.ccr;
+    cpu->registers->pc = outcome.pc;
+
+    // Only the runs of bytes that changed, so dirty tracking and the decode
+    // caches see no more than what the native run touched.
+    for (size_t index = 0; index < watched.size(); index++)
+    {
+        const Watched& memory = watched[index];
+        const uint8_t* saved = outcome.memories[index].data();
+
+        size_t address = 0;
+        while (address < memory.size)
+        {
+            if (memory.memory->buffer[address] == saved[address])
+            {
+                address++;
+                continue;
+            }
+
+            const size_t start = address;
+            while (address < memory.size && memory.memory->buffer[address] != saved[address])
+            {
+                address++;
+            }
+
+            memory.memory->Revert(static_cast<uint16_t>(start), saved + start, address - start);
+        }
+    }
+}
+
+void Hle::Compare(const HleRoutine& routine, const Outcome& expected, const Outcome& actual) const
+{
+    for (uint8_t index = 0; index < 8; index++)
+    {
+        if (~routine.checkedRegisters & 1 << index)
+        {
+            continue;
+        }
+
+        uint32_t native;
+        uint32_t interpreted;
+        std::memcpy(&native, expected.registers + index * 4, sizeof(native));
+        std::memcpy(&interpreted, actual.registers + index * 4, sizeof(interpreted));
+
+        if (native != interpreted)
+        {
+            throw HleMismatch(std::format("HLE {} at 0x{:04X} does not match the firmware (er{} 0x{:08X}/0x{:08X})", routine.name, routine.entry, index, native, interpreted));
+        }
+    }
+
+    const uint16_t sp = static_cast<uint16_t>(*cpu->registers->sp);
+    for (size_t index = 0; index < watched.size(); index++)
+    {
+        const Watched& memory = watched[index];
+        const bool isRam = memory.memory == cpu->ram;
+
+        for (size_t address = 0; address < memory.size; address++)
+        {
+            if (expected.memories[index][address] == actual.memories[index][address])
+            {
+                continue;
+            }
+
+            // Register pages don't hold what the routine did, only how, and
+            // the stack below sp is dead.
+            if (memory.memory->IsIOPage(address) || (isRam && address < sp && address + STACK_SCRATCH >= sp))
+            {
+                continue;
+            }
+
+            throw HleMismatch(std::format("HLE {} at 0x{:04X} does not match the firmware ({} 0x{:04X} 0x{:02X}/0x{:02X})", routine.name, routine.entry, memory.memory->name, address, expected.memories[index][address], actual.memories[index][address]));
+        }
+    }
+}
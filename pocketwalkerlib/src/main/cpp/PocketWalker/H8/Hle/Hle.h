@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Cpu/Cpu.h"
+
+class H8300H;
+class Memory;
+
+// How a replaced routine hands control back.
+enum class HleReturn : uint8_t
+{
+    // Pop the return address, as the routine's own rts would.
+    Rts,
+    // Carry on skipBytes past the entry, for hooks on a call site.
+    Skip
+};
+
+struct HleRoutine
+{
+    std::string name;
+    uint16_t entry;
+
+    // Does the routine's work on the machine. Returns false, before changing
+    // anything, to leave this call to the firmware.
+    std::function<bool(Cpu*)> run;
+
+    // Cycles the whole call takes on hardware, from the registers at entry.
+    std::function<size_t(Cpu*)> cost;
+
+    HleReturn returnConvention = HleReturn::Rts;
+    uint16_t skipBytes = 0;
+
+    // Runs on every call, replaced or not.
+    std::function<void(Cpu*)> observe;
+
+    // Bit n set for every ern verification compares. The rest are scratch the
+    // firmware's version may leave anything in. Defaults to the callee saved
+    // er4-er6 and sp.
+    uint8_t checkedRegisters = 0xF0;
+
+    bool isEnabled = false;
+    bool isVerifying = false;
+
+    // For native versions that rest on a guess. Enabled, every call is
+    // verified, the firmware's own run is always the one kept.
+    bool isVerifyOnly = false;
+
+    // Cycles the firmware took for the last verified call, to compare against
+    // cost.
+    size_t interpretedCycles = 0;
+    size_t verifiedCost = 0;
+};
+
+// A verified call that came out differently natively and in the firmware.
+class HleMismatch : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Routines the firmware calls that are run natively instead. Each one hooks
+// its entry pc, and once enabled does its work in a single step that is
+// charged the cycles the firmware would have taken, so throttled timing and
+// the timers see the same thing.
+//
+// With verification on, a call runs natively, the result is noted, the
+// registers and watched memory are put back and the firmware runs the call
+// itself. Devices the routine drives are left where the native run took
+// them, the firmware sets them up again anyway. Once it returns the two are
+// compared and a mismatch throws HleMismatch. Interrupts are held off until
+// then, as the native call gave them no chance to run either.
+class Hle
+{
+public:
+    Hle(H8300H* emulator, Cpu* cpu, Memory* ram, size_t ramSize);
+
+    // Installs the entry hook. Routines start out disabled unless the entry
+    // says otherwise.
+    void Add(const HleRoutine& routine);
+
+    // False if there is no routine by that name.
+    bool SetEnabled(const std::string& name, bool enabled);
+    bool SetVerifying(const std::string& name, bool verifying);
+
+    const HleRoutine* Find(const std::string& name) const;
+
+    // Besides RAM, memory verification compares, for routines writing into
+    // device buffers.
+    void Watch(Memory* memory, size_t size);
+
+    // From H8300H::Step, after every step while a verification is pending.
+    bool IsVerifying() const { return pending.routine != nullptr; }
+    void CheckVerification();
+
+    // RAM this far below the stack pointer is dead once a call returns, and
+    // left out of the comparison.
+    static constexpr uint16_t STACK_SCRATCH = 0x100;
+
+    // With interrupts held off, a firmware call waiting on one never returns.
+    // Verification gives up on it with an error after this long.
+    static constexpr uint64_t VERIFY_CYCLE_LIMIT = Cpu::TICKS;
+
+private:
+    struct Watched
+    {
+        Memory* memory;
+        size_t size;
+    };
+
+    struct Outcome
+    {
+        uint8_t registers[32];
+        uint8_t ccr;
+        uint16_t pc;
+        std::vector<std::vector<uint8_t>> memories;
+    };
+
+    struct Pending
+    {
+        HleRoutine* routine = nullptr;
+        uint16_t returnPc;
+        uint32_t returnSp;
+        uint64_t startCycles;
+        Outcome expected;
+    };
+
+    PCHandlerResult Call(HleRoutine& routine);
+    PCHandlerResult Verify(HleRoutine& routine);
+    void Return(const HleRoutine& routine) const;
+    Outcome Capture() const;
+    void Restore(const Outcome& outcome) const;
+    void Compare(const HleRoutine& routine, const Outcome& expected, const Outcome& actual) const;
+
+    H8300H* emulator;
+    Cpu* cpu;
+
+    // Stable addresses, the hooks hold on to their routine.
+    std::vector<HleRoutine*> routines;
+    std::vector<Watched> watched;
+
+    Pending pending;
+};
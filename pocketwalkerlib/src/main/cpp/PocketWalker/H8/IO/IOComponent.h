@@ -14,6 +14,8 @@ public:
 
     virtual void Reset() { }
 
+    // Asked whenever one of the chip select ports is written rather than on
+    // every transfer, so only look at the ports.
     virtual bool CanExecute(Ssu* ssu)
     {
         return true;
@@ -23,9 +25,4 @@ public:
     {
         return false;
     }
-    
-    virtual bool IsProgressive()
-    {
-        return false;
-    }
 };
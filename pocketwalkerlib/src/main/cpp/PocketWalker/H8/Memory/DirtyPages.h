@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Which pages of a Memory buffer were written since the consumer last looked.
+// Every consumer gets its own map from Memory::TrackDirtyPages, so fetching
+// never steals marks from another one.
+//
+// A page is one flag byte rather than one bit, so marking is a plain release
+// store and never an atomic read-modify-write on the emulator thread. Fetch
+// swaps the flag out with acquire, so another thread that sees a page as
+// dirty also sees the bytes that were written to it.
+class DirtyPages
+{
+public:
+    DirtyPages(const size_t size, const uint8_t pageShift) :
+        pageShift(pageShift),
+        count((size + (static_cast<size_t>(1) << pageShift) - 1) >> pageShift),
+        flags(new std::atomic<uint8_t>[count])
+    {
+        Fill(true);
+    }
+
+    void Mark(const size_t address, const size_t size)
+    {
+        const size_t first = address >> pageShift;
+        const size_t last = (address + size - 1) >> pageShift;
+
+        for (size_t page = first; page <= last && page < count; page++)
+        {
+            flags[page].store(1, std::memory_order_release);
+        }
+    }
+
+    // True if the page was written since the last fetch, and clears it.
+    bool Fetch(const size_t page)
+    {
+        return flags[page].exchange(0, std::memory_order_acquire) != 0;
+    }
+
+    // True if any page overlapping the range was written, and clears them.
+    bool FetchRange(const size_t address, const size_t size)
+    {
+        bool isDirty = false;
+        for (size_t page = address >> pageShift; page <= (address + size - 1) >> pageShift && page < count; page++)
+        {
+            isDirty |= Fetch(page);
+        }
+
+        return isDirty;
+    }
+
+    // Calls onPage with the index of every page written since the last
+    // fetch, clearing them as it goes.
+    template<typename F>
+    void FetchAll(F&& onPage)
+    {
+        for (size_t page = 0; page < count; page++)
+        {
+            if (flags[page].load(std::memory_order_relaxed) && Fetch(page))
+            {
+                onPage(page);
+            }
+        }
+    }
+
+    // For consumers that lost track of the contents, e.g. after a state load.
+    void Fill(const bool isDirty)
+    {
+        for (size_t page = 0; page < count; page++)
+        {
+            flags[page].store(isDirty, std::memory_order_release);
+        }
+    }
+
+    size_t PageSize() const { return static_cast<size_t>(1) << pageShift; }
+    size_t PageCount() const { return count; }
+
+private:
+    uint8_t pageShift;
+    size_t count;
+    std::unique_ptr<std::atomic<uint8_t>[]> flags;
+};
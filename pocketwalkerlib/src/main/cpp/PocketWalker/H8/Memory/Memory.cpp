@@ -13,76 +13,53 @@ std::string Memory::ReadString(uint16_t address, size_t size)
     return data;
 }
 
-uint8_t Memory::ReadByte(uint16_t address) const
+Memory::Page* Memory::IOPage(const uint16_t address)
 {
-    address &= 0xFFFF;
-    const uint8_t value = this->buffer[address];
-    
-    if (const auto it = readHandlers.find(address); it != readHandlers.end())
+    Page*& page = pages[address >> 8];
+    if (page == nullptr)
     {
-        it->second(value);
+        page = new Page();
     }
-    
-    return value;
-}
 
-uint16_t Memory::ReadShort(uint16_t address) const
-{
-    address &= 0xFFFF;
-    const uint16_t value = this->buffer[address] << 8 | this->buffer[address + 1];
-    
-    if (const auto it = readHandlers.find(address); it != readHandlers.end())
-    {
-        it->second(value);
-    }
-    
-    return value;
+    return page;
 }
 
-uint32_t Memory::ReadInt(uint16_t address) const
+void Memory::DispatchRead(const uint16_t address, const size_t size) const
 {
-    address &= 0xFFFF;
-    
-    const uint32_t value = this->buffer[address] << 24 | this->buffer[address + 1] << 16 | this->buffer[address + 2] << 8 | this->buffer[address + 3];
-   
-    if (const auto it = readHandlers.find(address); it != readHandlers.end())
+    for (size_t offset = 0; offset < size; offset++)
     {
-        it->second(value);
-    }
-    
-    return value;
-}
+        const uint16_t byteAddress = address + offset;
+        const Page* page = pages[byteAddress >> 8];
 
-void Memory::WriteByte(uint16_t address, const uint8_t value) const
-{
-    this->buffer[address] = value;
+        if (page != nullptr && page->read[byteAddress & 0xFF])
+        {
+            if (isSilent.load(std::memory_order_relaxed))
+            {
+                ioAccesses++;
+                continue;
+            }
 
-    if (const auto it = writeHandlers.find(address); it != writeHandlers.end())
-    {
-        it->second(value);
+            page->read[byteAddress & 0xFF](buffer[byteAddress]);
+        }
     }
 }
 
-void Memory::WriteShort(uint16_t address, uint16_t value) const
+void Memory::DispatchWrite(const uint16_t address, const size_t size) const
 {
-    this->buffer[address] = value >> 8 & 0xFF;
-    this->buffer[address + 1] = value & 0xFF;
-    \
-    if (const auto it = writeHandlers.find(address); it != writeHandlers.end())
+    for (size_t offset = 0; offset < size; offset++)
     {
-        it->second(value);
-    }
-}
+        const uint16_t byteAddress = address + offset;
+        const Page* page = pages[byteAddress >> 8];
 
-void Memory::WriteInt(uint16_t address, uint32_t value) const
-{
-    this->buffer[address] = value >> 24 & 0xFF;
-    this->buffer[address + 1] = value >> 16 & 0xFF;
-    this->buffer[address + 2] = value >> 8 & 0xFF;
-    this->buffer[address + 3] = value & 0xFF;
-    
-    if (const auto it = writeHandlers.find(address); it != writeHandlers.end())
-    {
-        it->second(value);
+        if (page != nullptr && page->write[byteAddress & 0xFF])
+        {
+            if (isSilent.load(std::memory_order_relaxed))
+            {
+                ioAccesses++;
+                continue;
+            }
+
+            page->write[byteAddress & 0xFF](buffer[byteAddress]);
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,11 +1,16 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <string>
+#include <vector>
 
+#include "DirtyPages.h"
 #include "MemoryAccessor.h"
 
 using MemoryHandler = std::function<void(uint32_t)>;
+using MemoryWriteObserver = std::function<void(uint16_t address, size_t size)>;
 
 class Memory
 {
@@ -20,34 +25,207 @@ public:
         this->buffer = new uint8_t[size]();
     }
     
+    // Registering a handler turns its whole 256 byte page into an I/O page.
     void OnRead(uint16_t address, const MemoryHandler& onRead)
     {
-        readHandlers[address] = onRead;
+        IOPage(address)->read[address & 0xFF] = onRead;
     }
     
     void OnWrite(uint16_t address, const MemoryHandler& onWrite)
     {
-        writeHandlers[address] = onWrite;
+        IOPage(address)->write[address & 0xFF] = onWrite;
     }
 
+    // True once any handler is registered in the page holding address.
+    bool IsIOPage(const uint16_t address) const
+    {
+        return pages[address >> 8] != nullptr;
+    }
+
+    // Called for every write regardless of address, after the buffer changed.
+    void OnAnyWrite(const MemoryWriteObserver& observer)
+    {
+        writeObservers.push_back(observer);
+    }
+
+    // A new dirty page map over the first size bytes, marked by every write
+    // from here on and living as long as this Memory. It starts out all
+    // dirty. Only register from the emulator thread or before it starts.
+    DirtyPages* TrackDirtyPages(size_t size, uint8_t pageShift)
+    {
+        dirtyPages.push_back(new DirtyPages(size, pageShift));
+        return dirtyPages.back();
+    }
+
+    // For changes made straight to the buffer.
+    void MarkDirty(const size_t address, const size_t size) const
+    {
+        for (DirtyPages* pages : dirtyPages)
+        {
+            pages->Mark(address, size);
+        }
+    }
+
+    // While silent, accesses only touch the buffer: no handlers, observers
+    // or dirty pages, so code can be run a second time on the side without
+    // the devices noticing. Accesses to bytes with a handler are counted
+    // instead.
+    void SetSilent(const bool value)
+    {
+        isSilent.store(value, std::memory_order_relaxed);
+        ioAccesses = 0;
+    }
+
+    size_t IOAccesses() const { return ioAccesses; }
+
     template<typename T>
     MemoryAccessor<T> CreateAccessor(uint16_t address) {
         return MemoryAccessor<T>(this, address);
     }
 
     std::string ReadString(uint16_t address, size_t size);
-    uint8_t ReadByte(uint16_t address) const;
-    uint16_t ReadShort(uint16_t address) const;
-    uint32_t ReadInt(uint16_t address) const;
-    
-    void WriteByte(uint16_t address, uint8_t value) const;
-    void WriteShort(uint16_t address, uint16_t value) const;
-    void WriteInt(uint16_t address, uint32_t value) const;
+
+    uint8_t ReadByte(const uint16_t address) const
+    {
+        const uint8_t value = buffer[address];
+
+        if (IsIO(address, 1))
+        {
+            DispatchRead(address, 1);
+        }
+
+        return value;
+    }
+
+    uint16_t ReadShort(const uint16_t address) const
+    {
+        const uint16_t value = buffer[address] << 8 | buffer[address + 1];
+
+        if (IsIO(address, 2))
+        {
+            DispatchRead(address, 2);
+        }
+
+        return value;
+    }
+
+    uint32_t ReadInt(const uint16_t address) const
+    {
+        const uint32_t value = buffer[address] << 24 | buffer[address + 1] << 16 | buffer[address + 2] << 8 | buffer[address + 3];
+
+        if (IsIO(address, 4))
+        {
+            DispatchRead(address, 4);
+        }
+
+        return value;
+    }
+
+    void WriteByte(const uint16_t address, const uint8_t value) const
+    {
+        buffer[address] = value;
+        Written(address, 1);
+    }
+
+    void WriteShort(const uint16_t address, const uint16_t value) const
+    {
+        buffer[address] = value >> 8 & 0xFF;
+        buffer[address + 1] = value & 0xFF;
+        Written(address, 2);
+    }
+
+    void WriteInt(const uint16_t address, const uint32_t value) const
+    {
+        buffer[address] = value >> 24 & 0xFF;
+        buffer[address + 1] = value >> 16 & 0xFF;
+        buffer[address + 2] = value >> 8 & 0xFF;
+        buffer[address + 3] = value & 0xFF;
+        Written(address, 4);
+    }
+
+    // One copy for the whole range, observers and dirty pages see it as a
+    // single write. I/O registers in the range still get their handlers.
+    void WriteBytes(const uint16_t address, const uint8_t* data, const size_t size) const
+    {
+        std::memcpy(buffer + address, data, size);
+        Written(address, size);
+    }
+
+    // Puts back bytes the caller changed itself. Observers and dirty pages
+    // see it like any write, I/O handlers don't run.
+    void Revert(const uint16_t address, const uint8_t* data, const size_t size) const
+    {
+        std::memcpy(buffer + address, data, size);
+        MarkDirty(address, size);
+
+        for (const MemoryWriteObserver& observer : writeObservers)
+        {
+            observer(address, size);
+        }
+    }
 
     std::string name = "Memory";
     uint8_t* buffer;
 
 private:
-    std::unordered_map<uint16_t, MemoryHandler> readHandlers;
-    std::unordered_map<uint16_t, MemoryHandler> writeHandlers;
+    // Per register handlers for one page, empty where nothing is mapped.
+    struct Page
+    {
+        MemoryHandler read[256];
+        MemoryHandler write[256];
+    };
+
+    bool IsIO(const uint16_t address, const size_t size) const
+    {
+        // Only WriteBytes gets here with a range that can span more than
+        // two pages.
+        if (size > 4)
+        {
+            for (size_t page = address >> 8; page <= (address + size - 1) >> 8 && page < 256; page++)
+            {
+                if (pages[page] != nullptr)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        return pages[address >> 8] != nullptr || pages[static_cast<uint16_t>(address + size - 1) >> 8] != nullptr;
+    }
+
+    void Written(const uint16_t address, const size_t size) const
+    {
+        if (!isSilent.load(std::memory_order_relaxed))
+        {
+            MarkDirty(address, size);
+
+            for (const MemoryWriteObserver& observer : writeObservers)
+            {
+                observer(address, size);
+            }
+        }
+
+        if (IsIO(address, size))
+        {
+            DispatchWrite(address, size);
+        }
+    }
+
+    Page* IOPage(uint16_t address);
+
+    // Run the handler of every byte the access covered, each with its own
+    // byte value.
+    void DispatchRead(uint16_t address, size_t size) const;
+    void DispatchWrite(uint16_t address, size_t size) const;
+
+    // nullptr for plain RAM/ROM pages, which never leave the inline path.
+    Page* pages[256] = {};
+    std::vector<MemoryWriteObserver> writeObservers;
+    std::vector<DirtyPages*> dirtyPages;
+
+    // Read by writes from any thread.
+    std::atomic<bool> isSilent = false;
+    mutable size_t ioAccesses = 0;
 };
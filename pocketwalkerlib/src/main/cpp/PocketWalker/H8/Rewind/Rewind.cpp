@@ -0,0 +1,246 @@
+#include "Rewind.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../H8300H.h"
+#include "../Memory/DirtyPages.h"
+#include "../../Utilities/StateSerializer.h"
+
+void Rewind::Capture()
+{
+    StateWriter writer(latest.size());
+    emulator->SaveState(writer);
+
+    if (latest.empty())
+    {
+        Track(writer);
+        latest = std::move(writer.data);
+        return;
+    }
+
+    Frame frame{};
+    if (HasLayout(writer))
+    {
+        StateWriter delta;
+        const uint8_t* current = writer.data.data();
+
+        size_t position = 0;
+        for (const Region& region : regions)
+        {
+            EncodeRange(current, position, region.offset - position, delta);
+
+            const size_t pageSize = region.dirty->PageSize();
+            region.dirty->FetchAll([&](const size_t page)
+            {
+                const size_t start = page * pageSize;
+                const size_t end = std::min(start + pageSize, region.size);
+                EncodeRange(current, region.offset + start, end - start, delta);
+            });
+
+            position = region.offset + region.size;
+        }
+
+        EncodeRange(current, position, writer.data.size() - position, delta);
+
+        frame.isKeyframe = false;
+        frame.data = std::move(delta.data);
+    }
+    else
+    {
+        frame.isKeyframe = true;
+        frame.data = std::move(latest);
+    }
+
+    latest = std::move(writer.data);
+    for (size_t index = 0; index < regions.size(); index++)
+    {
+        regions[index].offset = writer.regions[index].offset;
+    }
+
+    // Keyframes didn't look at the pages.
+    ClearDirty();
+    isAtLatest = false;
+
+    usage += frame.data.size();
+    frames.push_back(std::move(frame));
+    Trim();
+}
+
+bool Rewind::StepBack()
+{
+    if (latest.empty())
+    {
+        return false;
+    }
+
+    if (isAtLatest)
+    {
+        if (frames.empty())
+        {
+            return false;
+        }
+
+        Frame& frame = frames.back();
+        if (frame.isKeyframe)
+        {
+            latest = std::move(frame.data);
+        }
+        else
+        {
+            ApplyDelta(frame.data);
+        }
+
+        usage -= frame.data.size();
+        frames.pop_back();
+    }
+
+    emulator->LoadState(latest.data(), latest.size());
+
+    // The buffers were filled straight from latest, so nothing is really
+    // dirty, but a keyframe may have moved the regions around.
+    StateWriter writer(latest.size());
+    emulator->SaveState(writer);
+    for (size_t index = 0; index < regions.size(); index++)
+    {
+        regions[index].offset = writer.regions[index].offset;
+    }
+
+    ClearDirty();
+    isAtLatest = true;
+
+    return true;
+}
+
+size_t Rewind::Count() const
+{
+    if (latest.empty())
+    {
+        return 0;
+    }
+
+    return isAtLatest ? frames.size() : frames.size() + 1;
+}
+
+void Rewind::Track(const StateWriter& writer)
+{
+    for (const StateWriter::Region& region : writer.regions)
+    {
+        DirtyPages* dirty = region.memory->TrackDirtyPages(region.size, PAGE_SHIFT);
+        dirty->Fill(false);
+
+        regions.push_back({ region.memory, region.offset, region.size, dirty });
+    }
+}
+
+bool Rewind::HasLayout(const StateWriter& writer) const
+{
+    if (writer.data.size() != latest.size() || writer.regions.size() != regions.size())
+    {
+        return false;
+    }
+
+    for (size_t index = 0; index < regions.size(); index++)
+    {
+        if (writer.regions[index].offset != regions[index].offset || writer.regions[index].memory != regions[index].memory)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Rewind::ClearDirty()
+{
+    for (const Region& region : regions)
+    {
+        region.dirty->Fill(false);
+    }
+}
+
+void Rewind::Trim()
+{
+    while (!frames.empty() && Usage() > budget)
+    {
+        usage -= frames.front().data.size();
+        frames.pop_front();
+    }
+}
+
+// Each range is its offset and size followed by the XOR of the two states in
+// runs: a control byte below 0x80 is followed by that many plus one XORed
+// bytes, one at or above 0x80 stands for (c & 0x7F) + 1 unchanged bytes.
+void Rewind::EncodeRange(const uint8_t* current, const size_t offset, const size_t size, StateWriter& delta) const
+{
+    const uint8_t* previous = latest.data() + offset;
+    current += offset;
+
+    if (size == 0 || std::memcmp(current, previous, size) == 0)
+    {
+        return;
+    }
+
+    delta.Write<uint32_t>(offset);
+    delta.Write<uint32_t>(size);
+
+    std::vector<uint8_t>& out = delta.data;
+    size_t index = 0;
+    while (index < size)
+    {
+        size_t run = 0;
+        while (index + run < size && run < 0x80 && current[index + run] == previous[index + run])
+        {
+            run++;
+        }
+
+        if (run > 0)
+        {
+            out.push_back(static_cast<uint8_t>(0x80 | (run - 1)));
+            index += run;
+            continue;
+        }
+
+        const size_t control = out.size();
+        out.push_back(0);
+
+        size_t count = 0;
+        while (index < size && count < 0x80 && current[index] != previous[index])
+        {
+            out.push_back(current[index] ^ previous[index]);
+            index++;
+            count++;
+        }
+
+        out[control] = static_cast<uint8_t>(count - 1);
+    }
+}
+
+void Rewind::ApplyDelta(const std::vector<uint8_t>& delta)
+{
+    StateReader reader(delta.data(), delta.size());
+
+    while (reader.Position() < delta.size())
+    {
+        const uint32_t offset = reader.Read<uint32_t>();
+        const uint32_t size = reader.Read<uint32_t>();
+
+        uint8_t* target = latest.data() + offset;
+        size_t index = 0;
+        while (index < size)
+        {
+            const uint8_t control = reader.Read<uint8_t>();
+            const size_t count = (control & 0x7F) + 1;
+
+            if (~control & 0x80)
+            {
+                for (size_t byte = 0; byte < count; byte++)
+                {
+                    target[index + byte] ^= reader.Read<uint8_t>();
+                }
+            }
+
+            index += count;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class H8300H;
+class Memory;
+class DirtyPages;
+class StateWriter;
+class StateReader;
+
+// Ring of past machine states to step backwards through. Only the newest
+// capture is kept whole, every older one is the XOR against the capture after
+// it, run-length encoded. Memory contents only go into that delta for the
+// pages written in between, everything else in the state is small enough to
+// compare in full.
+class Rewind
+{
+public:
+    Rewind(H8300H* emulator, size_t budget) : emulator(emulator), budget(budget)
+    {
+    }
+
+    // From the emulator thread only.
+    void Capture();
+
+    // The first call after a capture restores that capture, every call after
+    // that goes one capture further back. False once there is nothing older.
+    bool StepBack();
+
+    // How many more StepBack calls will succeed.
+    size_t Count() const;
+
+    // Bytes held, the newest capture included. The oldest captures are
+    // dropped to stay under the budget.
+    size_t Usage() const { return usage + latest.size(); }
+
+    static constexpr uint8_t PAGE_SHIFT = 8;
+
+private:
+    // A Memory buffer inside latest, and the pages written since it was taken.
+    struct Region
+    {
+        Memory* memory;
+        size_t offset;
+        size_t size;
+        DirtyPages* dirty;
+    };
+
+    struct Frame
+    {
+        // Layout changes (the SCI3 receive queue changing length) can't be
+        // XORed, those frames hold the whole older state instead.
+        bool isKeyframe;
+        std::vector<uint8_t> data;
+    };
+
+    void Track(const StateWriter& writer);
+    bool HasLayout(const StateWriter& writer) const;
+    void ClearDirty();
+    void Trim();
+
+    void EncodeRange(const uint8_t* current, size_t offset, size_t size, StateWriter& delta) const;
+    void ApplyDelta(const std::vector<uint8_t>& delta);
+
+    H8300H* emulator;
+    size_t budget;
+
+    std::vector<uint8_t> latest;
+    std::vector<Region> regions;
+    std::deque<Frame> frames;
+    size_t usage = 0;
+
+    // The machine was put back to latest and hasn't captured since.
+    bool isAtLatest = false;
+};
@@ -3,6 +3,7 @@
 #include <ctime>
 
 #include "../../Utilities/BitUtilities.h"
+#include "../../Utilities/StateSerializer.h"
 
 void Rtc::Tick()
 {
@@ -17,12 +18,12 @@ void Rtc::Tick()
         isInitialized = true;
     }
     
-    const time_t currentTime = std::time(nullptr);
+    const time_t currentTime = clock();
     std::tm localTime;
-#if ANDROID
-    localtime_r(&currentTime, &localTime);
-#else
+#ifdef _WIN32
     localtime_s(&localTime, &currentTime);
+#else
+    localtime_r(&currentTime, &localTime);
 #endif
 
     second = BitUtilities::BinaryEncodedDecimal(localTime.tm_sec);
@@ -56,3 +57,24 @@ void Rtc::Tick()
     
     lastTime = localTime;
 }
+
+// Only the fields Tick compares against are kept from lastTime.
+void Rtc::SaveState(StateWriter& writer) const
+{
+    writer.Write(isInitialized);
+    writer.Write<uint64_t>(quarterCount);
+
+    writer.Write<int32_t>(lastTime.tm_sec);
+    writer.Write<int32_t>(lastTime.tm_min);
+    writer.Write<int32_t>(lastTime.tm_hour);
+}
+
+void Rtc::LoadState(StateReader& reader)
+{
+    reader.Read(isInitialized);
+    quarterCount = reader.Read<uint64_t>();
+
+    lastTime.tm_sec = reader.Read<int32_t>();
+    lastTime.tm_min = reader.Read<int32_t>();
+    lastTime.tm_hour = reader.Read<int32_t>();
+}
@@ -1,9 +1,14 @@
 #pragma once
+#include <ctime>
+#include <functional>
+
 #include "../Board/Component.h"
 #include "../Memory/Memory.h"
 #include "../Cpu/Components/Interrupts.h"
 
 class Interrupts;
+class StateWriter;
+class StateReader;
 
 class Rtc : public Component
 {
@@ -19,9 +24,15 @@ public:
 
     void Tick() override;
 
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
+
     bool isInitialized;
     size_t quarterCount;
     std::tm lastTime;
+
+    // Where the wall time comes from, the host's clock unless replaced.
+    std::function<std::time_t()> clock = [] { return std::time(nullptr); };
     
     MemoryAccessor<uint8_t> second;
     MemoryAccessor<uint8_t> minute;
@@ -1,5 +1,9 @@
 #include "Sci3.h"
 
+#include <vector>
+
+#include "../../Utilities/StateSerializer.h"
+
 void Sci3::Tick()
 {
     if (~control & Sci3Flags::CONTROL_TRANSMIT_ENABLE)
@@ -9,26 +13,35 @@ void Sci3::Tick()
 
     if (control & Sci3Flags::CONTROL_TRANSMIT_ENABLE)
     {
-        if (~status & Sci3Flags::STATUS_TRANSMIT_EMPTY)
+        // With the ring full the byte stays in the register until the host
+        // catches up, the firmware just sees a slow line. With nothing
+        // registered to drain it the byte goes out to nobody, as with no
+        // one in front of the IR window.
+        if (~status & Sci3Flags::STATUS_TRANSMIT_EMPTY && (OnTransmitData.Empty() || transmitRing.Push(transmit)))
         {
-            OnTransmitData(transmit);
-
             status |= Sci3Flags::STATUS_TRANSMIT_EMPTY;
             status |= Sci3Flags::STATUS_TRANSMIT_END;
+
+            transmitIdleTicks = 0;
+        }
+    }
+
+    if (const size_t pending = transmitRing.Size(); pending > 0)
+    {
+        if (++transmitIdleTicks >= FLUSH_TICKS || pending >= RING_SIZE / 2)
+        {
+            OnTransmitData(pending);
+            transmitIdleTicks = 0;
         }
     }
 
-    
     if (control & Sci3Flags::CONTROL_RECEIVE_ENABLE)
     {
         if (~status & Sci3Flags::STATUS_RECEIVE_FULL)
         {
-            std::lock_guard lock(receiveMutex);
-            if (!receiveBuffer.empty())
+            uint8_t receiveValue;
+            if (receiveRing.Pop(receiveValue))
             {
-                const uint8_t receiveValue = receiveBuffer.front();
-                receiveBuffer.pop();
-                
                 receive = receiveValue;
                 status |= Sci3Flags::STATUS_RECEIVE_FULL;
             }
@@ -36,8 +49,37 @@ void Sci3::Tick()
     }
 }
 
-void Sci3::Receive(const uint8_t byte)
+size_t Sci3::Receive(const uint8_t* data, const size_t size)
+{
+    return receiveRing.Push(data, size);
+}
+
+bool Sci3::Receive(const uint8_t byte)
 {
-    std::lock_guard lock(receiveMutex);
-    receiveBuffer.push(byte);
+    return receiveRing.Push(byte);
+}
+
+size_t Sci3::DrainTransmit(uint8_t* data, const size_t size)
+{
+    return transmitRing.Pop(data, size);
+}
+
+void Sci3::SaveState(StateWriter& writer)
+{
+    uint8_t pending[RING_SIZE];
+    const uint32_t count = static_cast<uint32_t>(receiveRing.Peek(pending, RING_SIZE));
+
+    writer.Write(count);
+    writer.WriteBytes(pending, count);
+}
+
+void Sci3::LoadState(StateReader& reader)
+{
+    receiveRing.Clear();
+
+    const uint32_t count = reader.Read<uint32_t>();
+    std::vector<uint8_t> pending(count);
+    reader.ReadBytes(pending.data(), count);
+
+    receiveRing.Push(pending.data(), pending.size());
 }
@@ -1,15 +1,16 @@
 #pragma once
 #include <cstdint>
-#include <mutex>
-#include <queue>
 #include <print>
 
 #include "../../Utilities/EventHandler.h"
+#include "../../Utilities/SpscRing.h"
 #include "../Board/Component.h"
 #include "../Memory/Memory.h"
 #include "../Memory/MemoryAccessor.h"
 
 class Memory;
+class StateWriter;
+class StateReader;
 
 namespace Sci3Flags
 {
@@ -52,11 +53,28 @@ public:
 
     void Tick() override;
 
-    void Receive(uint8_t byte);
+    // From the host's IR thread, never blocks. Returns how many bytes fit,
+    // the rest are dropped as a real receiver would overrun.
+    size_t Receive(const uint8_t* data, size_t size);
+    bool Receive(uint8_t byte);
 
-    std::queue<uint8_t> receiveBuffer;
+    // Room left for Receive. Only grows until the receiving thread pushes
+    // again.
+    size_t ReceiveSpace() const { return RING_SIZE - receiveRing.Size(); }
 
-    EventHandler<uint8_t> OnTransmitData;
+    // Takes up to size transmitted bytes, from one host thread at a time.
+    size_t DrainTransmit(uint8_t* data, size_t size);
+
+    // Includes the bytes still queued for receive. Only while the emulator
+    // and the host's IR thread are both stopped.
+    void SaveState(StateWriter& writer);
+    void LoadState(StateReader& reader);
+
+    // Transmitted bytes are waiting in the ring, the argument is how many.
+    // Fires once the transmitter has gone quiet for FLUSH_TICKS, the end of
+    // a packet, or when the ring is half full, rather than for every byte.
+    // Until something subscribes, transmitted bytes are dropped instead.
+    EventHandler<size_t> OnTransmitData;
 
     MemoryAccessor<uint8_t> control;
     MemoryAccessor<uint8_t> status;
@@ -65,6 +83,10 @@ public:
     
     static constexpr size_t TICKS = 32678;
 
+    // About a millisecond.
+    static constexpr size_t FLUSH_TICKS = 32;
+    static constexpr size_t RING_SIZE = 2048;
+
 private:
     Memory* ram;
 
@@ -73,6 +95,9 @@ private:
     static constexpr uint16_t STATUS_ADDR = 0xFF9C;
     static constexpr uint16_t RECEIVE_ADDR = 0xFF9D;
 
-    std::mutex receiveMutex; 
-    
+    SpscRing<RING_SIZE> receiveRing;
+    SpscRing<RING_SIZE> transmitRing;
+
+    // Ticks since the last byte went out.
+    size_t transmitIdleTicks = 0;
 };
@@ -1,96 +1,132 @@
 #include "Ssu.h"
 
-#include <ranges>
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
 
 #include "../IO/IOComponent.h"
+#include "../../Utilities/StateSerializer.h"
 
-void Ssu::Tick()
+void Ssu::RegisterIOPeripheral(const Port port, const uint8_t pin, IOComponent* component)
 {
-    // not changing for checks, use "cached" value
-    auto enableFlag = this->enable.Get();
-    auto statusFlag = this->status.Get();
-    
-    if (~enableFlag & SsuFlags::Enable::TRANSMIT_ENABLE && ~statusFlag & SsuFlags::Status::TRANSMIT_EMPTY)
+    const Peripheral peripheral { port, pin, component->IsData(), component };
+
+    auto position = std::ranges::find_if(peripherals.begin(), peripherals.begin() + peripheralCount, [&](const Peripheral& other)
     {
-        this->status |= SsuFlags::Status::TRANSMIT_EMPTY;
-    }
+        return other.port > port || (other.port == port && other.pin >= pin);
+    });
 
-    if (enableFlag & SsuFlags::Enable::TRANSMIT_ENABLE && enableFlag & SsuFlags::Enable::RECEIVE_ENABLE)
+    if (position != peripherals.begin() + peripheralCount && position->port == port && position->pin == pin)
     {
-        if (~statusFlag & SsuFlags::Status::TRANSMIT_EMPTY)
-        {
-            ExecutePeripherals([this](IOComponent* peripheral)
-            {
-                peripheral->TransmitAndReceive(this);
-            });
-        }
+        *position = peripheral;
     }
-    else if (enableFlag & SsuFlags::Enable::TRANSMIT_ENABLE)
+    else
     {
-        if (~statusFlag & SsuFlags::Status::TRANSMIT_EMPTY)
+        if (peripheralCount == MAX_PERIPHERALS)
         {
-            ExecutePeripherals([this](IOComponent* peripheral)
-            {
-                peripheral->Transmit(this);
-            });
+            throw std::runtime_error("Too many ssu peripherals.");
         }
+
+        std::move_backward(position, peripherals.begin() + peripheralCount, peripherals.begin() + peripheralCount + 1);
+        *position = peripheral;
+        peripheralCount++;
     }
-    else if (enableFlag & SsuFlags::Enable::RECEIVE_ENABLE)
-    {
-        throw std::runtime_error("Unimplemented receive enable for ssu.");
-    }
+
+    SelectPeripherals();
 }
 
-void Ssu::RegisterIOPeripheral(Port port, uint8_t pin, IOComponent* component)
+uint8_t Ssu::GetPort(uint16_t address)
 {
-    if (!peripherals.contains(port)) {
-        peripherals[port] = std::map<uint8_t, IOComponent*>();
+    return ram->ReadByte(address);
+}
+
+void Ssu::StartTransfer()
+{
+    // With the transmitter off the byte is gone straight away.
+    if (~enable.Get() & SsuFlags::Enable::TRANSMIT_ENABLE)
+    {
+        status |= SsuFlags::Status::TRANSMIT_EMPTY;
+        return;
     }
-    
-    peripherals[port][pin] = component;
+
+    OnTransmit(ByteCycles());
 }
 
-uint8_t Ssu::GetPort(uint16_t address)
+void Ssu::CompleteTransfer()
 {
-    return ram->ReadByte(address);
+    const uint8_t enableFlag = enable.Get();
+    if (~enableFlag & SsuFlags::Enable::TRANSMIT_ENABLE)
+    {
+        return;
+    }
+
+    const bool isReceiving = enableFlag & SsuFlags::Enable::RECEIVE_ENABLE;
+    for (uint8_t mask = selected; mask != 0; mask &= mask - 1)
+    {
+        IOComponent* component = peripherals[std::countr_zero(mask)].component;
+
+        if (isReceiving)
+        {
+            component->TransmitAndReceive(this);
+        }
+        else
+        {
+            component->Transmit(this);
+        }
+    }
+
+    // The devices set the status flags. One that leaves the byte pending
+    // (the accelerometer after its address byte) gets it again a byte later.
+    if (~status.Get() & SsuFlags::Status::TRANSMIT_EMPTY)
+    {
+        OnTransmit(ByteCycles());
+    }
 }
 
-void Ssu::ExecutePeripherals(const std::function<void(IOComponent* peripheral)>& executeFunction,
-                             bool invertPortSelect, bool isTick)
+void Ssu::SelectPeripherals()
 {
-    for (const auto& port : peripherals | std::views::keys)
+    uint8_t mask = 0;
+    for (size_t index = 0; index < peripheralCount; index++)
     {
-        ExecutePeripherals(port, executeFunction, invertPortSelect, isTick);
+        if (IsSelected(peripherals[index], false))
+        {
+            mask |= 1 << index;
+        }
     }
+
+    selected = mask;
+}
+
+bool Ssu::IsSelected(const Peripheral& peripheral, const bool isInverted)
+{
+    const uint8_t portValue = GetPort(peripheral.port);
+
+    uint8_t comparePortValue = peripheral.isData ? portValue : ~portValue;
+    if (isInverted) comparePortValue = ~comparePortValue;
+
+    return comparePortValue & peripheral.pin && peripheral.component->CanExecute(this);
 }
 
-void Ssu::ExecutePeripherals(const Port port, const std::function<void(IOComponent* peripheral)>& executeFunction,
-    bool invertPortSelect, bool isTick)
+void Ssu::ResetDeselected(const Port port)
 {
-    for (const auto& pins = peripherals[port]; auto [pin, peripheral] : pins)
+    for (size_t index = 0; index < peripheralCount; index++)
     {
-        const uint8_t currentPortValue = GetPort(port);
-            
-        uint8_t comparePortValue = peripheral->IsData() ? currentPortValue : ~currentPortValue;
-        if (invertPortSelect) comparePortValue = ~comparePortValue;
-            
-        if (comparePortValue & pin && peripheral->CanExecute(this))
+        if (peripherals[index].port == port && IsSelected(peripherals[index], true))
         {
-            if (peripheral->IsProgressive() && isTick)
-            {
-                progress++;
-
-                if (progress == 7)
-                {
-                    progress = 0;
-                    executeFunction(peripheral);
-                }
-            }
-            else
-            {
-                executeFunction(peripheral);
-            }
+            peripherals[index].component->Reset();
         }
     }
 }
+
+void Ssu::SaveState(StateWriter& writer) const
+{
+    writer.Write<uint64_t>(clockRate);
+}
+
+void Ssu::LoadState(StateReader& reader)
+{
+    clockRate = reader.Read<uint64_t>();
+
+    // The ports came back with RAM, without their write handlers.
+    SelectPeripherals();
+}
@@ -1,6 +1,6 @@
 #pragma once
 #include <array>
-#include <map>
+#include <stdexcept>
 #include <print>
 
 #include "../Board/Component.h"
@@ -8,9 +8,12 @@
 #include "../Memory/Memory.h"
 #include "../Memory/MemoryAccessor.h"
 #include "../IO/IOComponent.h"
+#include "../../Utilities/EventHandler.h"
 
 class Memory;
 class IOComponent;
+class StateWriter;
+class StateReader;
 
 constexpr uint16_t MODE_ADDR = 0xF0E2;
 constexpr uint16_t ENABLE_ADDR = 0xF0E3;
@@ -95,6 +98,23 @@ public:
         {
             status &= ~SsuFlags::Status::TRANSMIT_EMPTY;
             status &= ~SsuFlags::Status::TRANSMIT_END;
+
+            StartTransfer();
+        });
+
+        ram->OnWrite(ENABLE_ADDR, [this](uint32_t enableFlag)
+        {
+            if (enableFlag & SsuFlags::Enable::RECEIVE_ENABLE && ~enableFlag & SsuFlags::Enable::TRANSMIT_ENABLE)
+            {
+                throw std::runtime_error("Unimplemented receive enable for ssu.");
+            }
+
+            // Nothing goes out with the transmitter off, a byte in flight is
+            // dropped when it would have finished.
+            if (~enableFlag & SsuFlags::Enable::TRANSMIT_ENABLE)
+            {
+                status |= SsuFlags::Status::TRANSMIT_EMPTY;
+            }
         });
 
         ram->OnWrite(MODE_ADDR, [this](uint32_t mode)
@@ -104,22 +124,30 @@ public:
         
         ram->OnWrite(PORT_1, [this](uint32_t)
         {
-            ExecutePeripherals(PORT_1, [](IOComponent* peripheral)
-            {
-                peripheral->Reset();
-            }, true, false);
+            ResetDeselected(PORT_1);
+            SelectPeripherals();
+        });
+
+        ram->OnWrite(PORT_3, [this](uint32_t)
+        {
+            SelectPeripherals();
+        });
+
+        ram->OnWrite(PORT_8, [this](uint32_t)
+        {
+            SelectPeripherals();
         });
         
         ram->OnWrite(PORT_9, [this](uint32_t)
         {
-            ExecutePeripherals(PORT_9, [](IOComponent* peripheral)
-            {
-                peripheral->Reset();
-            }, true, false);
+            ResetDeselected(PORT_9);
+            SelectPeripherals();
         });
         
         ram->OnWrite(PORT_B, [this](uint32_t port)
         {
+            SelectPeripherals();
+
             if (port & SsuFlags::PortB::IRQ0)
             {
                 if (!this->flags->interrupt)
@@ -130,14 +158,26 @@ public:
         });
     }
 
-    void Tick() override;
+    // Exchanges the byte in flight with the selected devices, scheduled by
+    // the owner ByteCycles after OnTransmit.
+    void CompleteTransfer();
 
+    // One byte at the current clock rate.
+    size_t ByteCycles() const { return 8 * clockRate; }
+
+    // Selected while pin is low in port, or high for data peripherals. Throws
+    // once MAX_PERIPHERALS are registered.
     void RegisterIOPeripheral(Port port, uint8_t pin, IOComponent* component);
 
     uint8_t GetPort(uint16_t address);
 
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
+
     size_t clockRate = 4;
-    uint8_t progress;
+
+    // A byte started going out, the argument is the cycles until it is done.
+    EventHandler<size_t> OnTransmit;
     
     MemoryAccessor<uint8_t> mode;
     MemoryAccessor<uint8_t> enable;
@@ -151,13 +191,33 @@ public:
     MemoryAccessor<uint8_t> port9;
     MemoryAccessor<uint8_t> portB;
 
+    static constexpr size_t MAX_PERIPHERALS = 8;
+
 private:
-    void ExecutePeripherals(const std::function<void(IOComponent* peripheral)>& executeFunction, bool invertPortSelect = false, bool isTick = true);
-    void ExecutePeripherals(Port port, const std::function<void(IOComponent* peripheral)>& executeFunction, bool invertPortSelect = false, bool isTick = true);
+    struct Peripheral
+    {
+        Port port;
+        uint8_t pin;
+        bool isData;
+        IOComponent* component;
+    };
+
+    void StartTransfer();
+
+    // Works out which peripherals are selected, only when a port they sit on
+    // is written (or restored), so a transfer never has to.
+    void SelectPeripherals();
+    bool IsSelected(const Peripheral& peripheral, bool isInverted);
+    void ResetDeselected(Port port);
     
     Memory* ram;
     Flags* flags;
     Interrupts* interrupts;
 
-    std::map<Port, std::map<uint8_t, IOComponent*>> peripherals;
+    // Sorted by port and then pin, the order a transfer reaches them in.
+    std::array<Peripheral, MAX_PERIPHERALS> peripherals{};
+    size_t peripheralCount = 0;
+
+    // Bit n set while peripherals[n] is selected.
+    uint8_t selected = 0;
 };
@@ -1,5 +1,7 @@
 #include "TimerB1.h"
 
+#include <limits>
+
 #include "../../Cpu/Components/Interrupts.h"
 
 void TimerB1::Tick()
@@ -1,5 +1,7 @@
 #include "TimerW.h"
 
+#include <limits>
+
 #include "../../Cpu/Components/Interrupts.h"
 
 void TimerW::Tick()
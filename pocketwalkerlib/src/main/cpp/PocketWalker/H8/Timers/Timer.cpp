@@ -1,5 +1,7 @@
 #include "Timer.h"
 
+#include "../../Utilities/StateSerializer.h"
+
 void Timer::Tick()
 {
     clockCycles++;
@@ -17,3 +19,25 @@ void Timer::Tick()
         w->Tick();
     }
 }
+
+void Timer::SaveState(StateWriter& writer) const
+{
+    writer.Write<uint64_t>(clockCycles);
+
+    writer.Write<uint64_t>(b1->clockRate);
+    writer.Write(b1->isCounting);
+
+    writer.Write<uint64_t>(w->clockRate);
+    writer.Write(w->isCounting);
+}
+
+void Timer::LoadState(StateReader& reader)
+{
+    clockCycles = reader.Read<uint64_t>();
+
+    b1->clockRate = reader.Read<uint64_t>();
+    reader.Read(b1->isCounting);
+
+    w->clockRate = reader.Read<uint64_t>();
+    reader.Read(w->isCounting);
+}
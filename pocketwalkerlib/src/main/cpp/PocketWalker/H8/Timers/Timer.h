@@ -6,6 +6,8 @@
 
 class TimerW;
 class Interrupts;
+class StateWriter;
+class StateReader;
 constexpr uint16_t CLOCK_STOP_1_ADDR = 0xFFFA;
 constexpr uint16_t CLOCK_STOP_2_ADDR = 0xFFFB;
 
@@ -40,6 +42,10 @@ public:
 
     void Tick() override;
 
+    // Covers B1 and W as well.
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
+
     size_t clockCycles;
 
     TimerB1* b1;
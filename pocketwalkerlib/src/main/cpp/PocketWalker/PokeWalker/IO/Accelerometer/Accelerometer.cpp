@@ -1,6 +1,7 @@
 #include "Accelerometer.h"
 
 #include "../../../H8/Ssu/Ssu.h"
+#include "../../../Utilities/StateSerializer.h"
 
 void Accelerometer::TransmitAndReceive(Ssu* ssu)
 {
@@ -63,3 +64,21 @@ void Accelerometer::Reset()
     state = GettingAddress;
     offset = 0;
 }
+
+void Accelerometer::SaveState(StateWriter& writer) const
+{
+    writer.WriteMemory(memory, MEMORY_SIZE);
+
+    writer.Write(state);
+    writer.Write(address);
+    writer.Write(offset);
+}
+
+void Accelerometer::LoadState(StateReader& reader)
+{
+    reader.ReadMemory(memory, MEMORY_SIZE);
+
+    reader.Read(state);
+    reader.Read(address);
+    reader.Read(offset);
+}
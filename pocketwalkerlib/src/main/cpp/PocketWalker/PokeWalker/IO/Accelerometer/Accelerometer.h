@@ -2,6 +2,9 @@
 #include "../../../H8/IO/IOComponent.h"
 #include "../../../H8/Memory/Memory.h"
 
+class StateWriter;
+class StateReader;
+
 class Accelerometer : public IOComponent
 {
 public:
@@ -15,13 +18,18 @@ public:
     
     Accelerometer()
     {
-        memory = new Memory(0x7F);
+        memory = new Memory(MEMORY_SIZE);
     }
     
     void TransmitAndReceive(Ssu* ssu) override;
     void Transmit(Ssu* ssu) override;
     void Reset() override;
 
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
+
+    static constexpr size_t MEMORY_SIZE = 0x7F;
+
     AccelerometerState state;
     uint16_t address;
     uint16_t offset;
@@ -4,10 +4,22 @@
 
 void Buttons::Press(const Button button)
 {
-    portB |= button;
+    held.fetch_or(button, std::memory_order_relaxed);
+    pressed.fetch_or(button, std::memory_order_relaxed);
 }
 
 void Buttons::Release(const Button button)
 {
-    portB &= ~button;
+    held.fetch_and(static_cast<uint8_t>(~button), std::memory_order_relaxed);
+}
+
+void Buttons::Tick()
+{
+    const uint8_t buttons = held.load(std::memory_order_relaxed) | pressed.exchange(0, std::memory_order_relaxed);
+    const uint8_t port = portB;
+
+    if ((port & ALL) != buttons)
+    {
+        portB = static_cast<uint8_t>((port & ~ALL) | buttons);
+    }
 }
@@ -1,4 +1,7 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+
 #include "../../../H8/IO/IOComponent.h"
 #include "../../../H8/Memory/MemoryAccessor.h"
 
@@ -17,9 +20,22 @@ public:
         
     }
 
+    // Safe from any thread. Port B only follows on the next Tick, so the
+    // interrupt and SSU handlers its write sets off run on the emulator
+    // thread. A press released before then still shows for one tick.
     void Press(Button button);
     void Release(Button button);
-    
+
+    // Emulator thread. Brings port B in line with the buttons held.
+    void Tick() override;
+
+    static constexpr size_t TICKS = 1000;
+
 private:
+    static constexpr uint8_t ALL = Center | Left | Right;
+
     MemoryAccessor<uint8_t> portB;
+
+    std::atomic<uint8_t> held = 0;
+    std::atomic<uint8_t> pressed = 0;
 };
@@ -1,6 +1,8 @@
 #include "Eeprom.h"
 
 #include "../../../H8/Ssu/Ssu.h"
+#include "../../../Utilities/StateSerializer.h"
+
 void Eeprom::TransmitAndReceive(Ssu* ssu)
 {
     switch (state)
@@ -97,3 +99,25 @@ void Eeprom::Reset()
     state = Waiting;
     offset = 0;
 }
+
+void Eeprom::SaveState(StateWriter& writer) const
+{
+    writer.WriteMemory(memory, MEMORY_SIZE);
+
+    writer.Write(state);
+    writer.Write(status);
+    writer.Write(highAddress);
+    writer.Write(lowAddress);
+    writer.Write(offset);
+}
+
+void Eeprom::LoadState(StateReader& reader)
+{
+    reader.ReadMemory(memory, MEMORY_SIZE);
+
+    reader.Read(state);
+    reader.Read(status);
+    reader.Read(highAddress);
+    reader.Read(lowAddress);
+    reader.Read(offset);
+}
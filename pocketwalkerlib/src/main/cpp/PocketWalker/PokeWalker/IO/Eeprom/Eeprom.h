@@ -2,6 +2,9 @@
 #include "../../../H8/Memory/Memory.h"
 #include "../../../H8/IO/IOComponent.h"
 
+class StateWriter;
+class StateReader;
+
 namespace EepromFlags
 {
     enum Commands : uint8_t
@@ -42,10 +45,8 @@ public:
     void Transmit(Ssu* ssu) override;
     void Reset() override;
 
-    bool IsProgressive() override
-    {
-        return true;
-    }
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
 
     EepromState state;
     uint8_t status;
@@ -54,4 +55,7 @@ public:
     uint16_t offset;
     
     Memory* memory;
+
+    // Size of the buffer handed to the constructor.
+    static constexpr size_t MEMORY_SIZE = 0xFFFF;
 };
@@ -0,0 +1,176 @@
+#include "EepromJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "Eeprom.h"
+#include "../../../Utilities/HashUtilities.h"
+#include "../../../Utilities/StateSerializer.h"
+
+EepromJournal::EepromJournal(Eeprom* eeprom, std::filesystem::path imagePath, std::filesystem::path logPath) :
+    eeprom(eeprom),
+    pages(eeprom->memory->TrackDirtyPages(Eeprom::MEMORY_SIZE, PAGE_SHIFT)),
+    imagePath(std::move(imagePath)),
+    logPath(std::move(logPath))
+{
+    Compact();
+}
+
+size_t EepromJournal::Flush()
+{
+    std::lock_guard lock(mutex);
+
+    StateWriter records;
+    std::vector<size_t> written;
+    pages->FetchAll([&](const size_t page)
+    {
+        uint8_t bytes[PAGE_SIZE] = {};
+        const size_t start = page * PAGE_SIZE;
+        std::memcpy(bytes, eeprom->memory->buffer + start, std::min(PAGE_SIZE, Eeprom::MEMORY_SIZE - start));
+
+        const uint16_t index = static_cast<uint16_t>(page);
+        uint32_t checksum = HashUtilities::Fnv1a32(reinterpret_cast<const uint8_t*>(&index), sizeof(index));
+        checksum = HashUtilities::Fnv1a32(bytes, PAGE_SIZE, checksum);
+
+        records.Write(index);
+        records.WriteBytes(bytes, PAGE_SIZE);
+        records.Write(checksum);
+
+        written.push_back(page);
+    });
+
+    std::error_code error;
+    if (!written.empty())
+    {
+        const auto previousSize = isLogCurrent ? std::filesystem::file_size(logPath, error) : 0;
+        const bool isAppending = isLogCurrent && !error;
+
+        StateWriter header;
+        if (!isAppending)
+        {
+            header.Write(imageChecksum);
+        }
+
+        std::ofstream log(logPath, std::ios::binary | (isAppending ? std::ios::app : std::ios::trunc));
+        log.write(reinterpret_cast<const char*>(header.data.data()), static_cast<std::streamsize>(header.data.size()));
+        log.write(reinterpret_cast<const char*>(records.data.data()), static_cast<std::streamsize>(records.data.size()));
+        log.close();
+
+        isLogCurrent = static_cast<bool>(log);
+        if (!log)
+        {
+            // Cut off whatever part of the records made it, so later ones
+            // still line up, and keep the pages for the next try.
+            if (isAppending)
+            {
+                std::filesystem::resize_file(logPath, previousSize, error);
+                isLogCurrent = !error;
+            }
+
+            for (const size_t page : written)
+            {
+                pages->Mark(page * PAGE_SIZE, PAGE_SIZE);
+            }
+        }
+    }
+
+    const auto size = std::filesystem::file_size(logPath, error);
+    return error ? 0 : static_cast<size_t>(size);
+}
+
+void EepromJournal::Compact()
+{
+    std::lock_guard lock(mutex);
+
+    // Anything written after this point is dirty again and lands in the
+    // emptied log on the next flush.
+    pages->Fill(false);
+
+    // Copied first so the checksum matches what goes into the file while the
+    // emulator keeps writing.
+    const std::vector<uint8_t> contents(eeprom->memory->buffer, eeprom->memory->buffer + Eeprom::MEMORY_SIZE);
+    const uint32_t checksum = HashUtilities::Fnv1a32(contents.data(), contents.size());
+
+    std::filesystem::path temporaryPath = imagePath;
+    temporaryPath += ".tmp";
+
+    std::ofstream image(temporaryPath, std::ios::binary | std::ios::trunc);
+    image.write(reinterpret_cast<const char*>(contents.data()), static_cast<std::streamsize>(contents.size()));
+    image.close();
+
+    std::error_code error;
+    if (image)
+    {
+        std::filesystem::rename(temporaryPath, imagePath, error);
+    }
+
+    if (!image || error)
+    {
+        // Keep the old image and log, and make sure the pages aren't lost.
+        std::filesystem::remove(temporaryPath, error);
+        pages->Fill(true);
+        return;
+    }
+
+    // From here the old log no longer matches the image, so a crash before
+    // the new header is written only loses the log, which the image covers.
+    imageChecksum = checksum;
+
+    StateWriter header;
+    header.Write(imageChecksum);
+
+    std::ofstream log(logPath, std::ios::binary | std::ios::trunc);
+    log.write(reinterpret_cast<const char*>(header.data.data()), static_cast<std::streamsize>(header.data.size()));
+    log.close();
+
+    isLogCurrent = static_cast<bool>(log);
+}
+
+bool EepromJournal::Recover(const std::filesystem::path& imagePath, const std::filesystem::path& logPath, uint8_t* buffer, const size_t size)
+{
+    std::ifstream image(imagePath, std::ios::binary);
+    if (!image)
+    {
+        return false;
+    }
+
+    std::fill_n(buffer, size, 0);
+    image.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+
+    std::ifstream log(logPath, std::ios::binary);
+    const std::vector<uint8_t> records((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+
+    // A log written against some other image, e.g. one Compact replaced just
+    // before a crash, is older than the image and left out.
+    if (records.size() < HEADER_SIZE || StateReader(records.data(), HEADER_SIZE).Read<uint32_t>() != HashUtilities::Fnv1a32(buffer, size))
+    {
+        return true;
+    }
+
+    // Records are fixed size, a short or corrupt one can only be the tail a
+    // crash cut off.
+    for (size_t position = HEADER_SIZE; position + RECORD_SIZE <= records.size(); position += RECORD_SIZE)
+    {
+        StateReader reader(records.data() + position, RECORD_SIZE);
+
+        const uint16_t index = reader.Read<uint16_t>();
+        uint8_t bytes[PAGE_SIZE];
+        reader.ReadBytes(bytes, PAGE_SIZE);
+        const uint32_t checksum = reader.Read<uint32_t>();
+
+        uint32_t expected = HashUtilities::Fnv1a32(reinterpret_cast<const uint8_t*>(&index), sizeof(index));
+        expected = HashUtilities::Fnv1a32(bytes, PAGE_SIZE, expected);
+
+        const size_t start = static_cast<size_t>(index) * PAGE_SIZE;
+        if (checksum != expected || start >= size)
+        {
+            break;
+        }
+
+        std::memcpy(buffer + start, bytes, std::min(PAGE_SIZE, size - start));
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+
+class Eeprom;
+class DirtyPages;
+
+// Persists the EEPROM as a base image plus an append-only log of the pages
+// written since. Each log record is the page index, the page as it was at
+// flush time and a checksum, so a record torn by a crash is simply dropped on
+// recovery.
+//
+// The log starts with the checksum of the image it applies to. Compact
+// replaces the image before the log, so a crash in between leaves a log that
+// no longer matches and is ignored, rather than replaying stale pages over
+// the new image.
+//
+// Flush and Compact may run on any thread while the emulator keeps going. A
+// page the firmware writes while it is being copied is dirty again
+// afterwards, so the next flush writes it out whole.
+class EepromJournal
+{
+public:
+    // Writes the current contents out as the new base image, so call it once
+    // the buffer holds what Recover returned, before the emulator starts.
+    EepromJournal(Eeprom* eeprom, std::filesystem::path imagePath, std::filesystem::path logPath);
+
+    // Appends a record for every page written since the last flush and
+    // returns the size of the log afterwards. If the write fails the pages
+    // stay dirty for the next flush.
+    size_t Flush();
+
+    // Writes a fresh base image and empties the log.
+    void Compact();
+
+    // Fills buffer from the base image and replays the log over it. False if
+    // there is no base image.
+    static bool Recover(const std::filesystem::path& imagePath, const std::filesystem::path& logPath, uint8_t* buffer, size_t size);
+
+    static constexpr uint8_t PAGE_SHIFT = 7;
+    static constexpr size_t PAGE_SIZE = 1 << PAGE_SHIFT;
+    static constexpr size_t RECORD_SIZE = sizeof(uint16_t) + PAGE_SIZE + sizeof(uint32_t);
+    static constexpr size_t HEADER_SIZE = sizeof(uint32_t);
+
+private:
+    Eeprom* eeprom;
+    DirtyPages* pages;
+
+    std::filesystem::path imagePath;
+    std::filesystem::path logPath;
+
+    // Of the image as Compact last wrote it, for the log header.
+    uint32_t imageChecksum = 0;
+
+    // Whether the log on disk starts with imageChecksum, otherwise the next
+    // flush starts it over.
+    bool isLogCurrent = false;
+
+    std::mutex mutex;
+};
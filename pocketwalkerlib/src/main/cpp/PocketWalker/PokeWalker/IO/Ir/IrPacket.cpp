@@ -0,0 +1,85 @@
+#include "IrPacket.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+std::vector<uint8_t> IrPacket::Plain() const
+{
+    if (payload.size() > MAX_PAYLOAD_SIZE)
+    {
+        throw std::invalid_argument(std::format("IR payload of {} bytes, at most {} fit", payload.size(), MAX_PAYLOAD_SIZE));
+    }
+
+    std::vector<uint8_t> data(HEADER_SIZE + payload.size());
+    data[0] = command;
+    data[1] = extra;
+    data[4] = static_cast<uint8_t>(session >> 24);
+    data[5] = static_cast<uint8_t>(session >> 16);
+    data[6] = static_cast<uint8_t>(session >> 8);
+    data[7] = static_cast<uint8_t>(session);
+    std::copy(payload.begin(), payload.end(), data.begin() + HEADER_SIZE);
+
+    const uint16_t checksum = Checksum(data.data(), data.size());
+    data[CHECKSUM_OFFSET] = static_cast<uint8_t>(checksum);
+    data[CHECKSUM_OFFSET + 1] = static_cast<uint8_t>(checksum >> 8);
+
+    return data;
+}
+
+std::vector<uint8_t> IrPacket::Encode() const
+{
+    std::vector<uint8_t> data = Plain();
+    for (uint8_t& byte : data)
+    {
+        byte ^= XOR_KEY;
+    }
+
+    return data;
+}
+
+bool IrPacket::Decode(const uint8_t* data, const size_t size, IrPacket& packet)
+{
+    if (size < HEADER_SIZE || size > MAX_SIZE)
+    {
+        return false;
+    }
+
+    uint8_t plain[MAX_SIZE];
+    for (size_t index = 0; index < size; index++)
+    {
+        plain[index] = data[index] ^ XOR_KEY;
+    }
+
+    const uint16_t checksum = plain[CHECKSUM_OFFSET] | plain[CHECKSUM_OFFSET + 1] << 8;
+    plain[CHECKSUM_OFFSET] = 0;
+    plain[CHECKSUM_OFFSET + 1] = 0;
+
+    if (Checksum(plain, size) != checksum)
+    {
+        return false;
+    }
+
+    packet.command = plain[0];
+    packet.extra = plain[1];
+    packet.session = plain[4] << 24 | plain[5] << 16 | plain[6] << 8 | plain[7];
+    packet.payload.assign(plain + HEADER_SIZE, plain + size);
+
+    return true;
+}
+
+uint16_t IrPacket::Checksum(const uint8_t* data, const size_t size, const uint16_t seed)
+{
+    uint32_t sum = seed;
+    for (size_t index = 0; index < size; index++)
+    {
+        sum += index & 1 ? data[index] : data[index] << 8;
+    }
+
+    while (sum >> 16)
+    {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+
+    return static_cast<uint16_t>(sum);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One packet of the walker's IR protocol. On the wire it is an eight byte
+// header (command, extra, checksum, session id) followed by up to 128 bytes
+// of payload, with every byte XORed with 0xAA.
+struct IrPacket
+{
+    uint8_t command = 0;
+    uint8_t extra = 0;
+
+    // Header bytes 4 to 7, big-endian.
+    uint32_t session = 0;
+
+    std::vector<uint8_t> payload;
+
+    // Header with the checksum filled in, then the payload. Throws
+    // std::invalid_argument if the payload is too long.
+    std::vector<uint8_t> Plain() const;
+
+    // Plain, obfuscated for the wire.
+    std::vector<uint8_t> Encode() const;
+
+    // False, leaving packet alone, if the bytes are not a whole packet or the
+    // checksum doesn't match.
+    static bool Decode(const uint8_t* data, size_t size, IrPacket& packet);
+
+    // The protocol's checksum over plain bytes. Even bytes are the high half
+    // of a 16-bit word, the sum is folded back to 16 bits.
+    static uint16_t Checksum(const uint8_t* data, size_t size, uint16_t seed = CHECKSUM_SEED);
+
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr size_t MAX_PAYLOAD_SIZE = 128;
+    static constexpr size_t MAX_SIZE = HEADER_SIZE + MAX_PAYLOAD_SIZE;
+
+    static constexpr uint8_t XOR_KEY = 0xAA;
+    static constexpr uint16_t CHECKSUM_SEED = 0x0002;
+
+    // Where the checksum sits, low byte first. It is computed with both
+    // zeroed.
+    static constexpr size_t CHECKSUM_OFFSET = 2;
+};
@@ -0,0 +1,78 @@
+#include "IrPort.h"
+
+#include "../../../H8/Sci3/Sci3.h"
+
+IrPort::IrPort(Sci3* sci3) : sci3(sci3)
+{
+    sci3->OnTransmitData += [this](const size_t pending)
+    {
+        Dispatch(pending);
+    };
+}
+
+void IrPort::SetByteHandler(const EventHandlerCallback<size_t>& handler)
+{
+    std::lock_guard lock(mutex);
+    byteHandler = handler;
+}
+
+void IrPort::SetPacketHandler(const EventHandlerCallback<const IrPacket&>& handler, const EventHandlerCallback<const std::vector<uint8_t>&>& otherHandler)
+{
+    std::lock_guard lock(mutex);
+    packetHandler = handler;
+    this->otherHandler = otherHandler;
+}
+
+bool IrPort::Receive(const IrPacket& packet) const
+{
+    const std::vector<uint8_t> data = packet.Encode();
+
+    // Space only grows until this thread pushes again.
+    if (sci3->ReceiveSpace() < data.size())
+    {
+        return false;
+    }
+
+    sci3->Receive(data.data(), data.size());
+    return true;
+}
+
+void IrPort::Dispatch(const size_t pending)
+{
+    // Copied so a handler can be replaced while this one runs.
+    EventHandlerCallback<size_t> byteHandler;
+    EventHandlerCallback<const IrPacket&> packetHandler;
+    EventHandlerCallback<const std::vector<uint8_t>&> otherHandler;
+    {
+        std::lock_guard lock(mutex);
+        byteHandler = this->byteHandler;
+        packetHandler = this->packetHandler;
+        otherHandler = this->otherHandler;
+    }
+
+    if (!packetHandler && byteHandler)
+    {
+        byteHandler(pending);
+        return;
+    }
+
+    uint8_t data[Sci3::RING_SIZE];
+    const size_t size = sci3->DrainTransmit(data, sizeof(data));
+    if (size == 0 || !packetHandler)
+    {
+        return;
+    }
+
+    // The walker sends a packet in one burst and then waits for the answer,
+    // so a burst is a packet, or else something shorter like an
+    // advertisement.
+    IrPacket packet;
+    if (IrPacket::Decode(data, size, packet))
+    {
+        packetHandler(packet);
+    }
+    else if (otherHandler)
+    {
+        otherHandler(std::vector<uint8_t>(data, data + size));
+    }
+}
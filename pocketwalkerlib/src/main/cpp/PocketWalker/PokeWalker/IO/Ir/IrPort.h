@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "IrPacket.h"
+#include "../../../Utilities/EventHandler.h"
+
+class Sci3;
+
+// Hands what the walker transmits over SCI3 to the host, either as bytes or a
+// whole, checksummed packet at a time, so a host playing the other side
+// doesn't have to frame and check them itself. Each burst the walker sends is
+// decoded once it goes quiet, and packets to receive are queued in one go.
+//
+// The port is the only reader of the transmit side. With no handler set it
+// drops what the walker sends, as with no one in front of the IR window.
+class IrPort
+{
+public:
+    IrPort(Sci3* sci3);
+
+    // Replaces the byte handler. It is told how many bytes are waiting and
+    // takes them with Sci3::DrainTransmit. Not called while a packet handler
+    // is set.
+    void SetByteHandler(const EventHandlerCallback<size_t>& handler);
+
+    // Replaces the packet handlers, and takes over from the byte handler
+    // while set. Bursts that don't decode as a packet, such as the single
+    // 0xFC byte a walker advertises itself with, go to otherHandler as they
+    // were sent. Both run on the emulator thread.
+    void SetPacketHandler(const EventHandlerCallback<const IrPacket&>& handler, const EventHandlerCallback<const std::vector<uint8_t>&>& otherHandler);
+
+    // Safe from any one thread besides the emulator's. False, with nothing
+    // queued, if the whole packet doesn't fit in the receive ring.
+    bool Receive(const IrPacket& packet) const;
+
+private:
+    void Dispatch(size_t pending);
+
+    Sci3* sci3;
+
+    // The handlers are set from host threads while the emulator calls them.
+    std::mutex mutex;
+    EventHandlerCallback<size_t> byteHandler;
+    EventHandlerCallback<const IrPacket&> packetHandler;
+    EventHandlerCallback<const std::vector<uint8_t>&> otherHandler;
+};
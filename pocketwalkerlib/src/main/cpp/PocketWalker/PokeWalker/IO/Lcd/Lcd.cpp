@@ -5,6 +5,7 @@
 
 #include "LcdData.h"
 #include "../../../H8/Ssu/Ssu.h"
+#include "../../../Utilities/StateSerializer.h"
 
 // Backend interface and color implementation
 
@@ -38,7 +39,7 @@ public:
 
 Lcd::Lcd(bool useMono)
 {
-    memory = new Memory(0x3200);
+    memory = new Memory(MEMORY_SIZE);
     useMonoBackend = useMono;
 
     if (useMonoBackend)
@@ -102,6 +103,59 @@ void Lcd::ClearColorQueue()
     colorDrawQueue.clear();
 }
 
+void Lcd::DrawImage(const uint8_t page, const uint8_t column, const uint8_t* data, const uint8_t width, const uint8_t pages)
+{
+    const size_t rowSize = static_cast<size_t>(width) * COLUMN_SIZE;
+
+    for (uint8_t row = 0; row < pages; row++)
+    {
+        // Same wrap as the page command, which only has four bits.
+        this->page = (page + row) & 0xF;
+        memory->WriteBytes(this->page * TOTAL_COLUMNS * COLUMN_SIZE + column * COLUMN_SIZE, data + row * rowSize, rowSize);
+    }
+
+    this->column = column + width;
+    offset = 0;
+}
+
+void Lcd::SaveState(StateWriter& writer) const
+{
+    writer.WriteMemory(memory, MEMORY_SIZE);
+
+    writer.Write(state);
+    writer.Write<uint64_t>(column);
+    writer.Write<uint64_t>(offset);
+    writer.Write<uint64_t>(page);
+    writer.Write(contrast);
+    writer.Write(pageOffset);
+    writer.Write(powerSaveMode);
+
+    writer.Write(walkerDrawn);
+    writer.Write(walkerFrameIndex);
+    writer.Write(lastWalkerHash);
+    writer.Write(hasWalkerHash);
+}
+
+void Lcd::LoadState(StateReader& reader)
+{
+    reader.ReadMemory(memory, MEMORY_SIZE);
+
+    reader.Read(state);
+    column = reader.Read<uint64_t>();
+    offset = reader.Read<uint64_t>();
+    page = reader.Read<uint64_t>();
+    reader.Read(contrast);
+    reader.Read(pageOffset);
+    reader.Read(powerSaveMode);
+
+    reader.Read(walkerDrawn);
+    reader.Read(walkerFrameIndex);
+    reader.Read(lastWalkerHash);
+    reader.Read(hasWalkerHash);
+
+    colorDrawQueue.clear();
+}
+
 // LcdColorBackend implementation
 
 void LcdColorBackend::Transmit(Lcd* lcd, Ssu* ssu)
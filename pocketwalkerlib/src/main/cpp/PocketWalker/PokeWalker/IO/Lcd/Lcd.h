@@ -11,6 +11,8 @@
 #include "../../../Utilities/EventHandler.h"
 
 class Memory;
+class StateWriter;
+class StateReader;
 
 class LcdBackend; // internal implementation detail
 
@@ -49,6 +51,16 @@ public:
     void Tick() override;
     bool CanExecute(Ssu* ssu) override;
 
+    // Controller memory and command state plus the walker animation
+    // tracking. The color buffer and draw queue are rebuilt on the next tick.
+    void SaveState(StateWriter& writer) const;
+    void LoadState(StateReader& reader);
+
+    // Writes an image already in controller layout (two bytes per column,
+    // one 8 pixel row of pages after the other) starting at page/column, and
+    // leaves page, column and offset where streaming it over the SSU would.
+    void DrawImage(uint8_t page, uint8_t column, const uint8_t* data, uint8_t width, uint8_t pages);
+
     enum LcdState : uint8_t
     {
         Waiting,
@@ -71,6 +83,7 @@ public:
     static constexpr uint8_t HEIGHT = 64;
     static constexpr uint8_t COLUMN_SIZE = 2;
     static constexpr uint8_t TOTAL_COLUMNS = 0xFF;
+    static constexpr size_t MEMORY_SIZE = 0x3200;
     // Base grayscale palette for the color renderer (index 0 = lightest,
     // index 3 = darkest) to match the original LCD brightness ordering.
     // These values are treated as 0xRRGGBB and combined with an opaque alpha
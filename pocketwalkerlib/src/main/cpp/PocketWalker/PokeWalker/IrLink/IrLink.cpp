@@ -0,0 +1,82 @@
+#include "IrLink.h"
+
+#include <algorithm>
+
+#include "../PokeWalker.h"
+
+IrLink::IrLink(PokeWalker* first, PokeWalker* second, const uint32_t baudRate) :
+    sides{ Side(first, first->GetElapsedCycles()), Side(second, second->GetElapsedCycles()) }
+{
+    SetBaudRate(baudRate);
+
+    // Bytes are taken as soon as the port hands them over, so it never drops
+    // them, and whatever is still queued at the end of a slice then.
+    for (Side& side : sides)
+    {
+        side.walker->OnTransmitSci3([this, &side](size_t)
+        {
+            Transmit(side);
+        });
+    }
+}
+
+void IrLink::Run(const uint64_t cycles)
+{
+    const uint64_t end = now + cycles;
+
+    while (now < end)
+    {
+        now = std::min(now + byteCycles, end);
+
+        for (Side& side : sides)
+        {
+            side.walker->RunUntil(side.origin + now);
+        }
+
+        // Bytes sent during the slice are timed from its end, which is as
+        // close as a slice gets.
+        for (Side& side : sides)
+        {
+            Transmit(side);
+        }
+
+        Deliver(0);
+        Deliver(1);
+    }
+}
+
+void IrLink::SetBaudRate(const uint32_t baudRate)
+{
+    byteCycles = std::max<uint64_t>(1, static_cast<uint64_t>(Cpu::TICKS) * BITS_PER_BYTE / baudRate);
+}
+
+void IrLink::Transmit(Side& side) const
+{
+    uint8_t data[Sci3::RING_SIZE];
+    const size_t size = side.walker->DrainSci3(data, sizeof(data));
+
+    for (size_t index = 0; index < size; index++)
+    {
+        const uint64_t arrival = std::max(now, side.lineFreeAt) + byteCycles;
+        side.inFlight.push_back({ arrival, data[index] });
+        side.lineFreeAt = arrival;
+    }
+}
+
+void IrLink::Deliver(const uint8_t from)
+{
+    Side& side = sides[from];
+    PokeWalker* receiver = sides[from ^ 1].walker;
+
+    while (!side.inFlight.empty() && side.inFlight.front().arrival <= now)
+    {
+        const InFlight byte = side.inFlight.front();
+        if (!receiver->ReceiveSci3(byte.byte))
+        {
+            break;
+        }
+
+        side.inFlight.pop_front();
+        OnDeliver({ from, byte.byte, byte.arrival });
+    }
+}
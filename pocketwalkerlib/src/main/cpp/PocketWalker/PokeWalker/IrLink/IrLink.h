@@ -0,0 +1,88 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <deque>
+
+#include "../../Utilities/EventHandler.h"
+
+class PokeWalker;
+
+// Points the IR ports of two walkers in one process at each other. The link
+// drives both machines itself, on the calling thread and in slices of one
+// byte time, so neither gets ahead of the other by more than that and a
+// session plays out the same on every run. Bytes arrive a byte time after
+// the line is free, at the configured baud rate.
+//
+// The walkers must not be started. The link takes over their OnTransmitSci3
+// callbacks, and nothing else should drain their transmit side.
+class IrLink
+{
+public:
+    IrLink(PokeWalker* first, PokeWalker* second, uint32_t baudRate = DEFAULT_BAUD_RATE);
+
+    // The walkers' callbacks point back at this link.
+    IrLink(const IrLink&) = delete;
+    IrLink& operator=(const IrLink&) = delete;
+
+    // Runs both walkers for cycles more.
+    void Run(uint64_t cycles);
+
+    // Takes effect for bytes sent from here on.
+    void SetBaudRate(uint32_t baudRate);
+
+    // Cycles the link has run for, the same on both sides.
+    uint64_t Now() const { return now; }
+
+    uint64_t ByteCycles() const { return byteCycles; }
+
+    struct Delivery
+    {
+        // 0 for first, 1 for second.
+        uint8_t from;
+        uint8_t byte;
+        uint64_t cycle;
+
+        bool operator==(const Delivery&) const = default;
+    };
+
+    // Every byte as it reaches the other walker, for tracing sessions. cycle
+    // is when it was due, a byte held back for a full receive ring is
+    // reported once it goes in.
+    EventHandler<const Delivery&> OnDeliver;
+
+    static constexpr uint32_t DEFAULT_BAUD_RATE = 115200;
+
+    // Start bit, eight data bits and a stop bit.
+    static constexpr uint32_t BITS_PER_BYTE = 10;
+
+private:
+    struct InFlight
+    {
+        uint64_t arrival;
+        uint8_t byte;
+    };
+
+    struct Side
+    {
+        Side(PokeWalker* walker, const uint64_t origin) : walker(walker), origin(origin) { }
+
+        PokeWalker* walker;
+
+        // The walker's own cycle count when the link took over.
+        uint64_t origin;
+
+        // Bytes on their way to the other side, in arrival order. One the
+        // other walker's receive ring has no room for stays at the front
+        // until it has.
+        std::deque<InFlight> inFlight;
+        uint64_t lineFreeAt = 0;
+    };
+
+    void Transmit(Side& side) const;
+    void Deliver(uint8_t from);
+
+    std::array<Side, 2> sides;
+
+    uint64_t now = 0;
+    uint64_t byteCycles = 0;
+};
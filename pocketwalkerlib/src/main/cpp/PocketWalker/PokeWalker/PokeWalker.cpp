@@ -1,6 +1,10 @@
 #include "PokeWalker.h"
+#include "../H8/Hle/Hle.h"
 #include "../H8/Ssu/Ssu.h"
 #include "../../SleepConfig.h"
+#include "../Utilities/HashUtilities.h"
+#include "../Utilities/StateSerializer.h"
+#include <bit>
 #include <unordered_map>
 #include <string>
 
@@ -11,18 +15,6 @@
 #define PW_LOGD(fmt, ...) (void)0
 #endif
 
-// FNV-1a 32-bit hash function for detecting walker frame changes
-static uint32_t fnv1a_32(const uint8_t* data, size_t size)
-{
-    uint32_t hash = 0x811c9dc5u;
-    for (size_t i = 0; i < size; ++i)
-    {
-        hash ^= data[i];
-        hash *= 0x01000193u;
-    }
-    return hash;
-}
-
 // Helper to queue a color sprite draw command.
 static void QueueColorSprite(Lcd* lcd, const Lcd::FirmwareDrawEventArgs& args, const std::string& spriteId)
 {
@@ -109,8 +101,11 @@ static const std::unordered_map<uint16_t, std::string> kSpriteMap = {
     { 0x2350, "icon_pokewalker_large.png" },
 };
 
-PokeWalker::PokeWalker(uint8_t* ramBuffer, uint8_t* eepromBuffer) : H8300H(ramBuffer)
+PokeWalker::PokeWalker(uint8_t* ramBuffer, uint8_t* eepromBuffer, const ExecutionMode executionMode) : H8300H(ramBuffer, executionMode)
 {
+    // Hashed before anything runs, the firmware writes to both buffers.
+    bootKey = static_cast<uint64_t>(HashUtilities::Fnv1a32(ramBuffer, Board::RAM_SIZE)) << 32 | HashUtilities::Fnv1a32(eepromBuffer, Eeprom::MEMORY_SIZE);
+
     SetupAddressHandlers();
 
     eeprom = new Eeprom(eepromBuffer);
@@ -129,8 +124,31 @@ PokeWalker::PokeWalker(uint8_t* ramBuffer, uint8_t* eepromBuffer) : H8300H(ramBu
     RegisterIOComponent(beeper, Ssu::PORT_8, Ssu::PIN_2);
 
     buttons = new Buttons(board->ssu->portB);
+    irPort = new IrPort(board->sci3);
     RegisterIOComponent(buttons, Ssu::PORT_B, Ssu::PIN_0);
 
+    ScheduleComponents();
+
+    walkerSpritePages = board->ram->TrackDirtyPages(Board::RAM_SIZE, 6);
+
+    // drawImageToScreen writes here rather than RAM.
+    hle->Watch(lcd->memory, Lcd::MEMORY_SIZE);
+
+    // The first LCD write of a draw the firmware does itself gives away which
+    // page it targets.
+    drawPageBias.fill(-1);
+    lcd->memory->OnAnyWrite([this](const uint16_t address, size_t)
+    {
+        if (drawCalibrationRow < 0)
+        {
+            return;
+        }
+
+        const size_t page = address / (Lcd::TOTAL_COLUMNS * Lcd::COLUMN_SIZE);
+        drawPageBias[lcd->pageOffset & 0xF] = static_cast<int8_t>((page - drawCalibrationRow - lcd->pageOffset) & 0xF);
+        drawCalibrationRow = -1;
+    });
+
     // Attach a listener to the firmware draw event to queue color sprites
     lcd->OnFirmwareDraw += [this](const Lcd::FirmwareDrawEventArgs& args)
     {
@@ -146,8 +164,17 @@ PokeWalker::PokeWalker(uint8_t* ramBuffer, uint8_t* eepromBuffer) : H8300H(ramBu
                 return;
             }
 
-            const uint32_t walkerHash = fnv1a_32(args.pixelPtr, dataSize);
-            lcd->NotifyWalkerDrawn(walkerHash);
+            // Only rehash when the sprite moved or one of its pages was
+            // written since the last draw.
+            const uint16_t spriteAddress = static_cast<uint16_t>(args.pixelPtr - board->ram->buffer);
+            const bool isSpriteDirty = walkerSpritePages->FetchRange(spriteAddress, dataSize);
+            if (isSpriteDirty || args.pixelPtr != walkerSpritePixels)
+            {
+                walkerSpritePixels = args.pixelPtr;
+                walkerSpriteHash = HashUtilities::Fnv1a32(args.pixelPtr, dataSize);
+            }
+
+            lcd->NotifyWalkerDrawn(walkerSpriteHash);
 
             // Queue a color overlay for the walker sprite. The actual
             // Pokémon species is determined by GetWalkerDexNumber() on the
@@ -167,6 +194,24 @@ PokeWalker::PokeWalker(uint8_t* ramBuffer, uint8_t* eepromBuffer) : H8300H(ramBu
     };
 }
 
+PokeWalker::PokeWalker(const std::filesystem::path& romPath, const std::filesystem::path& eepromPath, const ExecutionMode executionMode) :
+    PokeWalker(new MappedFile(romPath, Board::RAM_SIZE, MappedFile::Mode::CopyOnWrite),
+               new MappedFile(eepromPath, Eeprom::MEMORY_SIZE, MappedFile::Mode::Shared),
+               executionMode)
+{
+}
+
+PokeWalker::PokeWalker(MappedFile* romFile, MappedFile* eepromFile, const ExecutionMode executionMode) :
+    PokeWalker(romFile->data, eepromFile->data, executionMode)
+{
+    this->romFile = romFile;
+    this->eepromFile = eepromFile;
+
+    // The file and the buffer are the same memory, nothing to sync yet.
+    eepromFilePages = eeprom->memory->TrackDirtyPages(Eeprom::MEMORY_SIZE, static_cast<uint8_t>(std::countr_zero(MappedFile::PageSize())));
+    eepromFilePages->Fill(false);
+}
+
 uint16_t PokeWalker::ResolveEepromAddress(const uint16_t ramAddr) const
 {
     if (eepromLoadHistoryCount == 0)
@@ -205,11 +250,9 @@ uint16_t PokeWalker::ResolveEepromAddress(const uint16_t ramAddr) const
     return 0;
 }
 
-void PokeWalker::Tick(uint64_t cycles)
+void PokeWalker::ScheduleComponents()
 {
-    H8300H::Tick(cycles);
-
-    if (cycles % (Cpu::TICKS / Lcd::TICKS) == 0)
+    board->scheduler->AddPeriodic(Cpu::TICKS / Lcd::TICKS, [this]()
     {
         const uint8_t currentlyActiveView = board->ram->ReadByte(0xFFF7B1);
         const uint8_t curSubstateY = board->ram->ReadByte(0xFFF7CE);
@@ -226,12 +269,46 @@ void PokeWalker::Tick(uint64_t cycles)
 
         lcd->SetUiState(uiState);
         lcd->Tick();
-    }
+    });
 
-    if (cycles % (Cpu::TICKS / Beeper::TICKS) == 0)
+    board->scheduler->AddPeriodic(Cpu::TICKS / Beeper::TICKS, [this]()
     {
         beeper->Tick();
-    }
+    });
+
+    board->scheduler->AddPeriodic(Cpu::TICKS / Buttons::TICKS, [this]()
+    {
+        buttons->Tick();
+    });
+}
+
+void PokeWalker::SaveComponents(StateWriter& writer) const
+{
+    eeprom->SaveState(writer);
+    accelerometer->SaveState(writer);
+    lcd->SaveState(writer);
+
+    writer.Write(fusedStepBudget);
+    writer.Write(eepromLoadHistory);
+    writer.Write<uint64_t>(eepromLoadHistoryCount);
+}
+
+void PokeWalker::LoadComponents(StateReader& reader)
+{
+    eeprom->LoadState(reader);
+    accelerometer->LoadState(reader);
+    lcd->LoadState(reader);
+
+    reader.Read(fusedStepBudget);
+    reader.Read(eepromLoadHistory);
+    eepromLoadHistoryCount = reader.Read<uint64_t>();
+
+    // Every snapshot is taken from a running machine, never mid-boot.
+    isBooted = true;
+
+    // The snapshot's firmware may be using its buffers differently.
+    drawPageBias.fill(-1);
+    drawCalibrationRow = -1;
 }
 
 void PokeWalker::OnDraw(const EventHandlerCallback<uint8_t*>& handler) const
@@ -249,14 +326,39 @@ void PokeWalker::OnAudio(const EventHandlerCallback<AudioInformation>& handler)
     beeper->OnPlayAudio += handler;
 }
 
-void PokeWalker::OnTransmitSci3(const EventHandlerCallback<uint8_t>& callback) const
+void PokeWalker::OnTransmitSci3(const EventHandlerCallback<size_t>& callback) const
+{
+    irPort->SetByteHandler(callback);
+}
+
+size_t PokeWalker::DrainSci3(uint8_t* data, const size_t size) const
+{
+    return board->sci3->DrainTransmit(data, size);
+}
+
+void PokeWalker::OnBootSnapshot(const EventHandlerCallback<const std::vector<uint8_t>&>& handler) const
+{
+    bootSnapshotHandler += handler;
+}
+
+size_t PokeWalker::ReceiveSci3(const uint8_t* data, const size_t size) const
+{
+    return board->sci3->Receive(data, size);
+}
+
+bool PokeWalker::ReceiveSci3(const uint8_t byte) const
+{
+    return board->sci3->Receive(byte);
+}
+
+void PokeWalker::OnTransmitIrPacket(const EventHandlerCallback<const IrPacket&>& handler, const EventHandlerCallback<const std::vector<uint8_t>&>& otherHandler) const
 {
-    board->sci3->OnTransmitData += callback;
+    irPort->SetPacketHandler(handler, otherHandler);
 }
 
-void PokeWalker::ReceiveSci3(const uint8_t byte) const
+bool PokeWalker::ReceiveIrPacket(const IrPacket& packet) const
 {
-    board->sci3->Receive(byte);
+    return irPort->Receive(packet);
 }
 
 void PokeWalker::PressButton(const Buttons::Button button) const
@@ -274,6 +376,39 @@ void PokeWalker::SetEepromBuffer(uint8_t* buffer) const
     eeprom->memory->buffer = buffer;
 }
 
+void PokeWalker::EnableEepromJournal(const std::filesystem::path& imagePath, const std::filesystem::path& logPath)
+{
+    eepromJournal = new EepromJournal(eeprom, imagePath, logPath);
+}
+
+size_t PokeWalker::FlushEepromJournal() const
+{
+    return eepromJournal != nullptr ? eepromJournal->Flush() : 0;
+}
+
+void PokeWalker::CompactEepromJournal() const
+{
+    if (eepromJournal != nullptr)
+    {
+        eepromJournal->Compact();
+    }
+}
+
+void PokeWalker::SyncEeprom() const
+{
+    if (eepromFile == nullptr)
+    {
+        return;
+    }
+
+    const size_t pageSize = eepromFilePages->PageSize();
+    eepromFilePages->FetchAll([&](const size_t page)
+    {
+        const size_t start = page * pageSize;
+        eepromFile->Sync(start, std::min(pageSize, Eeprom::MEMORY_SIZE - start));
+    });
+}
+
 uint8_t PokeWalker::GetContrast() const
 {
     return lcd->contrast - 20;
@@ -523,10 +658,18 @@ void PokeWalker::SetWalkerShinyCheat(const bool shiny) const
 void PokeWalker::SetupAddressHandlers() const
 {
     // prevent firmware sleep when the Power Saving Cheat is enabled
-    board->cpu->OnAddress(0x7944, [](Cpu* cpu)
+    board->cpu->OnAddress(0x7944, [this](Cpu* cpu)
     {
+        // first pass through the main loop, initialization is done
+        if (!isBooted)
+        {
+            isBooted = true;
+            bootSnapshotHandler(SaveState());
+        }
+
         if (g_disableSleep)
         {
+            cpu->flags->Resolve();
             cpu->flags->zero = false;
         }
 
@@ -568,7 +711,23 @@ void PokeWalker::SetupAddressHandlers() const
     //
     // DISASSEMBLY notes show eepromReadToRamAlso at 0x5384 with
     //   (r0 = eepromAddr, e0 = ramDstPtr, r1 = nbytes)
-    board->cpu->OnAddress(0x5384, [this](Cpu* cpu)
+    //
+    // Enabled, the copy itself is done natively as well.
+    HleRoutine eepromLoad{};
+    eepromLoad.name = "eepromReadToRamAlso";
+    eepromLoad.entry = 0x5384;
+    eepromLoad.observe = [this](Cpu* cpu)
+    {
+        const uint32_t er0 = *cpu->registers->Register32(0x0);
+        const uint32_t er1 = *cpu->registers->Register32(0x1);
+
+        const size_t index = eepromLoadHistoryCount % kEepromLoadHistorySize;
+        eepromLoadHistory[index].eepromAddr = static_cast<uint16_t>(er0 & 0xFFFFu);
+        eepromLoadHistory[index].ramDst = static_cast<uint16_t>((er0 >> 16) & 0xFFFFu);
+        eepromLoadHistory[index].length = static_cast<uint16_t>(er1 & 0xFFFFu);
+        ++eepromLoadHistoryCount;
+    };
+    eepromLoad.run = [this](Cpu* cpu)
     {
         const uint32_t er0 = *cpu->registers->Register32(0x0);
         const uint32_t er1 = *cpu->registers->Register32(0x1);
@@ -577,17 +736,39 @@ void PokeWalker::SetupAddressHandlers() const
         const uint16_t ramDst     = static_cast<uint16_t>((er0 >> 16) & 0xFFFFu);
         const uint16_t nbytes     = static_cast<uint16_t>(er1 & 0xFFFFu);
 
-        const size_t index = eepromLoadHistoryCount % kEepromLoadHistorySize;
-        eepromLoadHistory[index].eepromAddr = eepromAddr;
-        eepromLoadHistory[index].ramDst = ramDst;
-        eepromLoadHistory[index].length = nbytes;
-        ++eepromLoadHistoryCount;
-
-        return Continue;
-    });
+        // Anything that would wrap around either buffer is left to the
+        // firmware.
+        if (nbytes == 0 || eepromAddr + nbytes > Eeprom::MEMORY_SIZE || ramDst + nbytes > Board::RAM_SIZE)
+        {
+            return false;
+        }
 
-    // Spy on drawImageToScreen (0x80AC)
-    board->cpu->OnAddress(0x80AC, [this](Cpu* cpu)
+        board->ram->WriteBytes(ramDst, eeprom->memory->buffer + eepromAddr, nbytes);
+        return true;
+    };
+    eepromLoad.cost = [this](Cpu* cpu)
+    {
+        const uint16_t nbytes = static_cast<uint16_t>(*cpu->registers->Register32(0x1) & 0xFFFFu);
+
+        // On hardware the read command and two address bytes go out first,
+        // then every byte is one SSU transfer (Ssu::ByteCycles) plus the
+        // firmware's store/count/branch around it.
+        constexpr size_t kSetupCycles = 60;
+        constexpr size_t kLoopCycles = 24;
+        const size_t transferCycles = board->ssu->ByteCycles();
+        return kSetupCycles + 3 * transferCycles + nbytes * (transferCycles + kLoopCycles);
+    };
+    hle->Add(eepromLoad);
+
+    // Spy on drawImageToScreen (0x80AC). The native draw goes straight into
+    // LCD memory, but which page it targets is learnt from earlier draws
+    // rather than read from the firmware's own buffer state, so it is only
+    // ever checked against the firmware.
+    HleRoutine drawImage{};
+    drawImage.name = "drawImageToScreen";
+    drawImage.entry = 0x80AC;
+    drawImage.isVerifyOnly = true;
+    drawImage.observe = [this](Cpu* cpu)
     {
         const uint32_t er0 = *cpu->registers->Register32(0x0);
         const uint32_t er1 = *cpu->registers->Register32(0x1);
@@ -607,9 +788,51 @@ void PokeWalker::SetupAddressHandlers() const
         args.sourceAddr = ResolveEepromAddress(imageDataPtr);
 
         lcd->OnFirmwareDraw(args);
+    };
+    drawImage.run = [this](Cpu* cpu)
+    {
+        const uint32_t er0 = *cpu->registers->Register32(0x0);
+        const uint32_t er1 = *cpu->registers->Register32(0x1);
 
-        return Continue; // Allow the original firmware draw to complete
-    });
+        const uint8_t x = er0 & 0xFFu;
+        const uint8_t y = (er0 >> 8) & 0xFFu;
+        const uint8_t width = er1 & 0xFFu;
+        const uint8_t height = (er1 >> 8) & 0xFFu;
+        const uint16_t imageDataPtr = static_cast<uint16_t>((er0 >> 16) & 0xFFFFu);
+
+        const uint8_t pages = height / 8;
+        const size_t imageSize = static_cast<size_t>(width) * pages * Lcd::COLUMN_SIZE;
+        if (width == 0 || pages == 0 || y % 8 != 0 || height % 8 != 0 ||
+            x + width > Lcd::WIDTH || y + height > Lcd::HEIGHT || imageDataPtr + imageSize > Board::RAM_SIZE)
+        {
+            return false;
+        }
+
+        const int8_t pageBias = drawPageBias[lcd->pageOffset & 0xF];
+        if (pageBias < 0)
+        {
+            drawCalibrationRow = y / 8;
+            return false;
+        }
+
+        lcd->DrawImage(y / 8 + lcd->pageOffset + pageBias, x, cpu->ram->buffer + imageDataPtr, width, pages);
+        return true;
+    };
+    drawImage.cost = [this](Cpu* cpu)
+    {
+        const uint32_t er1 = *cpu->registers->Register32(0x1);
+        const size_t pages = ((er1 >> 8) & 0xFFu) / 8;
+        const size_t imageSize = (er1 & 0xFFu) * pages * Lcd::COLUMN_SIZE;
+
+        // Each page row is a page command and two column commands, then two
+        // data bytes per column, one SSU transfer each plus the firmware's loop.
+        constexpr size_t kSetupCycles = 60;
+        constexpr size_t kRowCycles = 40;
+        constexpr size_t kByteCycles = 16;
+        const size_t transferCycles = board->ssu->ByteCycles();
+        return kSetupCycles + pages * (kRowCycles + 3 * transferCycles) + imageSize * (transferCycles + kByteCycles);
+    };
+    hle->Add(drawImage);
 
     // Log when the firmware enters handleAccelSteps (0x945A).
     board->cpu->OnAddress(0x945A, [](Cpu* cpu)
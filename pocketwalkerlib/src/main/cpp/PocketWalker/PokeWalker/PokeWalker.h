@@ -3,29 +3,75 @@
 #include "../H8/H8300H.h"
 #include "IO/Lcd/Lcd.h"
 #include "IO/Eeprom/Eeprom.h"
+#include "IO/Eeprom/EepromJournal.h"
 #include "IO/Accelerometer/Accelerometer.h"
 #include "IO/Beeper/Beeper.h"
 #include "IO/Buttons/Buttons.h"
 #include "IO/Lcd/LcdData.h"
+#include "IO/Ir/IrPort.h"
+#include "../Utilities/MappedFile.h"
 
 class PokeWalker : public H8300H {
 public:
-    PokeWalker(uint8_t* ramBuffer, uint8_t* eepromBuffer);
+    PokeWalker(uint8_t* ramBuffer, uint8_t* eepromBuffer, ExecutionMode executionMode = ExecutionMode::Interpreter);
+
+    // Maps the ROM copy-on-write as the RAM image and the EEPROM file shared,
+    // so neither is copied. Firmware EEPROM writes land in the file's page
+    // cache, SyncEeprom makes them durable.
+    PokeWalker(const std::filesystem::path& romPath, const std::filesystem::path& eepromPath, ExecutionMode executionMode = ExecutionMode::Interpreter);
 
-    void Tick(uint64_t cycles);
-    
     void OnDraw(const EventHandlerCallback<uint8_t*>& handler) const;
     void OnFirmwareDraw(EventHandlerCallback<Lcd::FirmwareDrawEventArgs> handler) const;
     void OnAudio(const EventHandlerCallback<AudioInformation>& handler) const;
-    void OnTransmitSci3(const EventHandlerCallback<uint8_t>& callback) const;
-    void ReceiveSci3(uint8_t byte) const;
 
+    // IR traffic goes through lock-free rings. The callback runs on the
+    // emulator thread with the number of transmitted bytes waiting, once per
+    // packet or so, and DrainSci3 takes them. It replaces any earlier one,
+    // and without one the walker's transmissions are dropped. ReceiveSci3 is
+    // safe from any one other thread and returns how many bytes fit.
+    void OnTransmitSci3(const EventHandlerCallback<size_t>& callback) const;
+    size_t DrainSci3(uint8_t* data, size_t size) const;
+    size_t ReceiveSci3(const uint8_t* data, size_t size) const;
+    bool ReceiveSci3(uint8_t byte) const;
+
+    // The same traffic a packet at a time, see IrPort. While packet handlers
+    // are set the walker's transmissions are decoded natively and the
+    // OnTransmitSci3 callback isn't called, bursts that aren't a packet go to
+    // otherHandler. ReceiveIrPacket is false, queuing nothing, if the packet
+    // doesn't fit.
+    void OnTransmitIrPacket(const EventHandlerCallback<const IrPacket&>& handler, const EventHandlerCallback<const std::vector<uint8_t>&>& otherHandler) const;
+    bool ReceiveIrPacket(const IrPacket& packet) const;
+
+    // Fires once per cold boot, the first time the firmware reaches the sleep
+    // check in its main loop, with a save state of the machine at that point.
+    // Restoring it later skips the reset and initialization path entirely.
+    void OnBootSnapshot(const EventHandlerCallback<const std::vector<uint8_t>&>& handler) const;
+
+    // Identifies the ROM and EEPROM contents this instance was created from,
+    // a boot snapshot is only valid for the same key.
+    uint64_t GetBootKey() const { return bootKey; }
+
+    // Any thread. The firmware sees the change within a millisecond of
+    // emulated time.
     void PressButton(Buttons::Button button) const;
     void ReleaseButton(Buttons::Button button) const;
     
     void SetEepromBuffer(uint8_t* buffer) const;
     uint8_t* GetEepromBuffer() const;
 
+    // Persists EEPROM changes incrementally from here on, see EepromJournal.
+    // Call before the emulator starts.
+    void EnableEepromJournal(const std::filesystem::path& imagePath, const std::filesystem::path& logPath);
+
+    // Safe from any thread. Flush returns the log size, 0 while disabled.
+    size_t FlushEepromJournal() const;
+    void CompactEepromJournal() const;
+
+    // Writes the EEPROM pages changed since the last sync back to the mapped
+    // file and waits for them. Safe from any thread, does nothing unless the
+    // EEPROM is a mapped file.
+    void SyncEeprom() const;
+
     uint8_t GetContrast() const;
 
     const std::array<uint32_t, Lcd::WIDTH * Lcd::HEIGHT>& GetColorBuffer() const;
@@ -83,8 +129,15 @@ public:
     // 0x8F00 (moreFlags at +0x0E, bit 0x02).
     void SetWalkerShinyCheat(bool shiny) const;
 
+protected:
+    void SaveComponents(StateWriter& writer) const override;
+    void LoadComponents(StateReader& reader) override;
+
 private:
+    PokeWalker(MappedFile* romFile, MappedFile* eepromFile, ExecutionMode executionMode);
+
     void SetupAddressHandlers() const;
+    void ScheduleComponents();
 
     struct EepromLoadRecord
     {
@@ -99,13 +152,36 @@ private:
 
     uint16_t ResolveEepromAddress(uint16_t ramAddr) const;
 
+    // Which LCD page the firmware draws the top of the screen to, relative to
+    // the one being displayed (it may be drawing to a back buffer). Learnt
+    // from the first draw the firmware does itself at each display offset,
+    // since flipping buffers changes it, -1 until then.
+    mutable std::array<int8_t, 16> drawPageBias;
+    mutable int16_t drawCalibrationRow = -1;
+
     // Pending fused steps that have been accepted on the Android
     // side but not yet consumed by the firmware's step pipeline.
     mutable uint32_t fusedStepBudget = 0;
 
+    // Walker sprite hash from the last draw, reused while its RAM is
+    // untouched.
+    DirtyPages* walkerSpritePages;
+    const uint8_t* walkerSpritePixels = nullptr;
+    uint32_t walkerSpriteHash = 0;
+
+    uint64_t bootKey;
+    mutable bool isBooted = false;
+    mutable EventHandler<const std::vector<uint8_t>&> bootSnapshotHandler;
+
+    IrPort* irPort;
     Lcd* lcd;
     LcdData* lcdData;
     Eeprom* eeprom;
+    EepromJournal* eepromJournal = nullptr;
+
+    MappedFile* romFile = nullptr;
+    MappedFile* eepromFile = nullptr;
+    DirtyPages* eepromFilePages = nullptr;
     Accelerometer* accelerometer;
     Beeper* beeper;
     Buttons* buttons;
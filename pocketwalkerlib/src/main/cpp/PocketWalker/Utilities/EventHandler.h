@@ -28,6 +28,11 @@ public:
         callbacks.remove(callback);
     }
 
+    bool Empty() const
+    {
+        return callbacks.empty();
+    }
+
     
 private:
     std::list<EventHandlerCallback<T>> callbacks;
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class HashUtilities
+{
+public:
+    // FNV-1a 32-bit, cheap enough for change detection and record checksums.
+    static uint32_t Fnv1a32(const uint8_t* data, const size_t size, uint32_t hash = 0x811c9dc5u)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= data[i];
+            hash *= 0x01000193u;
+        }
+        return hash;
+    }
+    
+};
@@ -0,0 +1,135 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::filesystem::path& path, const size_t size, const Mode mode) : size(size), mode(mode), path(path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file && mode == Mode::CopyOnWrite)
+    {
+        throw std::runtime_error(std::format("Failed to open {}", path.string()));
+    }
+
+    data = new uint8_t[size]();
+    file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(size));
+}
+
+MappedFile::~MappedFile()
+{
+    delete[] data;
+}
+
+void MappedFile::Sync(const size_t offset, const size_t length) const
+{
+    if (mode != Mode::Shared)
+    {
+        return;
+    }
+
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file)
+    {
+        file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        return;
+    }
+
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(reinterpret_cast<const char*>(data + offset), static_cast<std::streamsize>(length));
+}
+
+size_t MappedFile::PageSize()
+{
+    return 4096;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path& path, const size_t size, const Mode mode) : size(size), mode(mode)
+{
+    const int file = open(path.c_str(), mode == Mode::Shared ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (file < 0)
+    {
+        throw std::runtime_error(std::format("Failed to open {}: {}", path.string(), std::strerror(errno)));
+    }
+
+    struct stat status{};
+    fstat(file, &status);
+    const size_t fileSize = static_cast<size_t>(status.st_size);
+
+    mappedSize = (size + PageSize() - 1) / PageSize() * PageSize();
+    void* mapping = MAP_FAILED;
+
+    if (mode == Mode::Shared)
+    {
+        if (fileSize < size && ftruncate(file, static_cast<off_t>(size)) != 0)
+        {
+            close(file);
+            throw std::runtime_error(std::format("Failed to grow {}: {}", path.string(), std::strerror(errno)));
+        }
+
+        mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    }
+    else
+    {
+        // Touching a page past the end of a file mapping is a SIGBUS, so the
+        // file only covers what it has and anonymous zero pages do the rest.
+        mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        const size_t fileLength = std::min(fileSize, size);
+        if (mapping != MAP_FAILED && fileLength > 0 &&
+            mmap(mapping, fileLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file, 0) == MAP_FAILED)
+        {
+            munmap(mapping, mappedSize);
+            mapping = MAP_FAILED;
+        }
+    }
+
+    close(file);
+
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error(std::format("Failed to map {}: {}", path.string(), std::strerror(errno)));
+    }
+
+    data = static_cast<uint8_t*>(mapping);
+}
+
+MappedFile::~MappedFile()
+{
+    munmap(data, mappedSize);
+}
+
+void MappedFile::Sync(const size_t offset, const size_t length) const
+{
+    if (mode != Mode::Shared)
+    {
+        return;
+    }
+
+    const size_t start = offset / PageSize() * PageSize();
+    msync(data + start, offset + length - start, MS_SYNC);
+}
+
+size_t MappedFile::PageSize()
+{
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return pageSize;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// A file mapped into memory as a fixed size buffer. Throws std::runtime_error
+// if the file can't be opened or mapped.
+class MappedFile
+{
+public:
+    enum class Mode
+    {
+        // Read from the file, writes stay private to the process. Anything
+        // past the end of the file reads as zero.
+        CopyOnWrite,
+
+        // Writes go to the file, which is grown to size if it is shorter.
+        Shared
+    };
+
+    MappedFile(const std::filesystem::path& path, size_t size, Mode mode);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Blocks until the range is on disk. Shared mappings only.
+    void Sync(size_t offset, size_t length) const;
+
+    // Granularity Sync works at.
+    static size_t PageSize();
+
+    uint8_t* data = nullptr;
+    size_t size;
+
+private:
+    Mode mode;
+
+#ifdef _WIN32
+    // No mmap here, the file is read in whole and Sync writes ranges back.
+    std::filesystem::path path;
+#else
+    size_t mappedSize = 0;
+#endif
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed size byte queue between exactly one producer thread and one consumer
+// thread, neither of which ever waits on the other. Push fails once the ring
+// is full rather than overwriting.
+template <size_t CAPACITY>
+class SpscRing
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    // Producer side.
+    bool Push(const uint8_t byte)
+    {
+        return Push(&byte, 1) == 1;
+    }
+
+    // Returns how many of the bytes fit.
+    size_t Push(const uint8_t* data, const size_t size)
+    {
+        const size_t tail = this->tail.load(std::memory_order_relaxed);
+        const size_t head = this->head.load(std::memory_order_acquire);
+
+        const size_t count = std::min(size, CAPACITY - (tail - head));
+        for (size_t index = 0; index < count; index++)
+        {
+            buffer[(tail + index) & MASK] = data[index];
+        }
+
+        this->tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side.
+    bool Pop(uint8_t& byte)
+    {
+        return Pop(&byte, 1) == 1;
+    }
+
+    // Returns how many bytes were taken, at most size.
+    size_t Pop(uint8_t* data, const size_t size)
+    {
+        const size_t count = Peek(data, size);
+        head.store(head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        return count;
+    }
+
+    // Like Pop, but the bytes stay queued.
+    size_t Peek(uint8_t* data, const size_t size) const
+    {
+        const size_t head = this->head.load(std::memory_order_relaxed);
+        const size_t tail = this->tail.load(std::memory_order_acquire);
+
+        const size_t count = std::min(size, tail - head);
+        for (size_t index = 0; index < count; index++)
+        {
+            data[index] = buffer[(head + index) & MASK];
+        }
+
+        return count;
+    }
+
+    void Clear()
+    {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // Only a snapshot, the other side may have moved on by the time it is
+    // used.
+    size_t Size() const
+    {
+        // Head first, tail can only have grown past it since.
+        const size_t head = this->head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - head;
+    }
+
+    static constexpr size_t Capacity() { return CAPACITY; }
+
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+
+    // Both only ever grow, the buffer index is the low bits. Kept on separate
+    // cache lines so the two threads don't fight over one.
+    alignas(64) std::atomic<size_t> head = 0;
+    alignas(64) std::atomic<size_t> tail = 0;
+    alignas(64) uint8_t buffer[CAPACITY] = {};
+};
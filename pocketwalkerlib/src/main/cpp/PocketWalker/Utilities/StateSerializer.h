@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../H8/Memory/Memory.h"
+
+// Flat binary save state streams. Fields are written back to back in host
+// byte order with no tags, so readers have to consume them in exactly the
+// order they were written; the version in the header guards layout changes.
+class StateWriter
+{
+public:
+    explicit StateWriter(const size_t expectedSize = 0)
+    {
+        data.reserve(expectedSize);
+    }
+
+    template<typename T>
+    void Write(const T value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(T));
+    }
+
+    void WriteBytes(const void* bytes, const size_t size)
+    {
+        const auto* begin = static_cast<const uint8_t*>(bytes);
+        data.insert(data.end(), begin, begin + size);
+    }
+
+    // Same as WriteBytes on the backing buffer, but remembers where it went
+    // so delta encoders can tell memory contents apart from the rest.
+    void WriteMemory(Memory* memory, const size_t size)
+    {
+        regions.push_back({ memory, data.size(), size });
+        WriteBytes(memory->buffer, size);
+    }
+
+    struct Region
+    {
+        Memory* memory;
+        size_t offset;
+        size_t size;
+    };
+
+    std::vector<uint8_t> data;
+    std::vector<Region> regions;
+};
+
+class StateReader
+{
+public:
+    StateReader(const uint8_t* data, const size_t size) : data(data), size(size)
+    {
+    }
+
+    template<typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        T value;
+        ReadBytes(&value, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void Read(T& value)
+    {
+        value = Read<T>();
+    }
+
+    void ReadBytes(void* bytes, const size_t count)
+    {
+        if (count > size - position)
+        {
+            throw std::runtime_error(std::format("Save state truncated, wanted {} bytes at offset {} of {}", count, position, size));
+        }
+
+        std::memcpy(bytes, data + position, count);
+        position += count;
+    }
+
+    // Counterpart of StateWriter::WriteMemory, the whole range is marked
+    // dirty for every page tracker on the memory.
+    void ReadMemory(Memory* memory, const size_t size)
+    {
+        ReadBytes(memory->buffer, size);
+        memory->MarkDirty(0, size);
+    }
+
+    size_t Position() const { return position; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position = 0;
+};
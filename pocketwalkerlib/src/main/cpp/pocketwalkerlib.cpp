@@ -3,6 +3,9 @@
 #include "KotlinCallback.h"
 #include <android/log.h>
 #include "SleepConfig.h"
+#include <filesystem>
+#include <format>
+#include <fstream>
 
 class CallbackManager {
 private:
@@ -44,38 +47,16 @@ JNIEXPORT void JNICALL
 Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_create(JNIEnv *env, jobject thiz,
                                                              jbyteArray rom_bytes,
                                                              jbyteArray eeprom_bytes) {
-    jsize romSize = env->GetArrayLength(rom_bytes);
-    jsize eepromSize = env->GetArrayLength(eeprom_bytes);
+    // Straight into the buffers the emulator keeps, anything past the end of
+    // a short array stays zero.
+    uint8_t* persistentRom = new uint8_t[0xFFFF]();
+    uint8_t* persistentEeprom = new uint8_t[0xFFFF]();
 
-    jbyte* romBuffer = env->GetByteArrayElements(rom_bytes, nullptr);
-    jbyte* eepromBuffer = env->GetByteArrayElements(eeprom_bytes, nullptr);
+    const jsize romCopySize = std::min<jsize>(env->GetArrayLength(rom_bytes), 0xFFFF);
+    const jsize eepromCopySize = std::min<jsize>(env->GetArrayLength(eeprom_bytes), 0xFFFF);
 
-    if (!romBuffer || !eepromBuffer) {
-        if (romBuffer) env->ReleaseByteArrayElements(rom_bytes, romBuffer, JNI_ABORT);
-        if (eepromBuffer) env->ReleaseByteArrayElements(eeprom_bytes, eepromBuffer, JNI_ABORT);
-        return;
-    }
-
-    auto fullRomBuffer = std::make_unique<std::array<uint8_t, 0xFFFF>>();
-    auto fullEepromBuffer = std::make_unique<std::array<uint8_t, 0xFFFF>>();
-
-    fullRomBuffer->fill(0);
-    fullEepromBuffer->fill(0);
-
-    size_t romCopySize = std::min(static_cast<size_t>(romSize), fullRomBuffer->size());
-    std::copy(romBuffer, romBuffer + romCopySize, fullRomBuffer->begin());
-
-    size_t eepromCopySize = std::min(static_cast<size_t>(eepromSize), fullEepromBuffer->size());
-    std::copy(eepromBuffer, eepromBuffer + eepromCopySize, fullEepromBuffer->begin());
-
-    env->ReleaseByteArrayElements(rom_bytes, romBuffer, JNI_ABORT);
-    env->ReleaseByteArrayElements(eeprom_bytes, eepromBuffer, JNI_ABORT);
-
-    uint8_t* persistentRom = new uint8_t[0xFFFF];
-    uint8_t* persistentEeprom = new uint8_t[0xFFFF];
-
-    std::copy(fullRomBuffer->begin(), fullRomBuffer->end(), persistentRom);
-    std::copy(fullEepromBuffer->begin(), fullEepromBuffer->end(), persistentEeprom);
+    env->GetByteArrayRegion(rom_bytes, 0, romCopySize, reinterpret_cast<jbyte*>(persistentRom));
+    env->GetByteArrayRegion(eeprom_bytes, 0, eepromCopySize, reinterpret_cast<jbyte*>(persistentEeprom));
 
     auto emulator = new PokeWalker(persistentRom, persistentEeprom);
     emulator->SetExceptionHandling(false);
@@ -418,11 +399,15 @@ Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_onTransmitSci3(JNIEnv *env
 
     CallbackManager::Instance().SetCallback(env, callback, "TransmitSCI3");
 
-    emulator->OnTransmitSci3([](uint8_t byte) {
+    // A whole packet per call instead of one boxed byte at a time.
+    emulator->OnTransmitSci3([](size_t) {
+        auto emulator = PocketWalkerState::Emulator();
         jobject transmitCallback = CallbackManager::Instance().GetCallback("TransmitSCI3");
-        if (transmitCallback) {
-            jbyte signedByte = static_cast<jbyte>(static_cast<int8_t>(byte));
-            KotlinCallback::InvokeByteCallback(transmitCallback, signedByte);
+
+        uint8_t data[Sci3::RING_SIZE];
+        const size_t size = emulator->DrainSci3(data, sizeof(data));
+        if (transmitCallback && size > 0) {
+            KotlinCallback::InvokeByteArrayCallback(transmitCallback, data, static_cast<jsize>(size));
         }
     });
 }
@@ -439,6 +424,83 @@ Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_receiveSci3(JNIEnv *env, j
     emulator->ReceiveSci3((uint8_t) byte);
 }
 
+// Returns how many of the bytes fit in the receive ring.
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_receiveSci3Bytes(JNIEnv *env, jobject thiz,
+                                                                       jbyteArray data) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator || !data) {
+        return 0;
+    }
+
+    const jsize size = std::min<jsize>(env->GetArrayLength(data), Sci3::RING_SIZE);
+    uint8_t bytes[Sci3::RING_SIZE];
+    env->GetByteArrayRegion(data, 0, size, reinterpret_cast<jbyte*>(bytes));
+
+    return static_cast<jint>(emulator->ReceiveSci3(bytes, static_cast<size_t>(size)));
+}
+
+// Whole packets instead of bytes: the header (checksum already checked) and
+// payload, without the wire obfuscation. Replaces onTransmitSci3 for the
+// walker's transmissions, anything that isn't a packet goes to other_callback
+// as it was sent.
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_onTransmitIrPacket(JNIEnv *env, jobject thiz,
+                                                                         jobject callback,
+                                                                         jobject other_callback) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return;
+    }
+
+    CallbackManager::Instance().SetCallback(env, callback, "TransmitIrPacket");
+    CallbackManager::Instance().SetCallback(env, other_callback, "TransmitIrOther");
+
+    emulator->OnTransmitIrPacket([](const IrPacket& packet) {
+        jobject packetCallback = CallbackManager::Instance().GetCallback("TransmitIrPacket");
+        if (packetCallback) {
+            std::vector<uint8_t> data = packet.Plain();
+            KotlinCallback::InvokeByteArrayCallback(packetCallback, data.data(), static_cast<jsize>(data.size()));
+        }
+    }, [](const std::vector<uint8_t>& data) {
+        jobject otherCallback = CallbackManager::Instance().GetCallback("TransmitIrOther");
+        if (otherCallback) {
+            KotlinCallback::InvokeByteArrayCallback(otherCallback, const_cast<uint8_t*>(data.data()), static_cast<jsize>(data.size()));
+        }
+    });
+}
+
+// The checksum and obfuscation are added natively. False if the payload is
+// too long or the receive side is still too full for the packet.
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_receiveIrPacket(JNIEnv *env, jobject thiz,
+                                                                      jint command,
+                                                                      jint extra,
+                                                                      jint session,
+                                                                      jbyteArray payload) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator || !payload) {
+        return JNI_FALSE;
+    }
+
+    const jsize size = env->GetArrayLength(payload);
+    if (size > static_cast<jsize>(IrPacket::MAX_PAYLOAD_SIZE)) {
+        return JNI_FALSE;
+    }
+
+    IrPacket packet;
+    packet.command = static_cast<uint8_t>(command);
+    packet.extra = static_cast<uint8_t>(extra);
+    packet.session = static_cast<uint32_t>(session);
+    packet.payload.resize(static_cast<size_t>(size));
+    env->GetByteArrayRegion(payload, 0, size, reinterpret_cast<jbyte*>(packet.payload.data()));
+
+    return emulator->ReceiveIrPacket(packet) ? JNI_TRUE : JNI_FALSE;
+}
+
 extern "C"
 JNIEXPORT void JNICALL
 Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_setAccelerationData(JNIEnv *env, jobject thiz,
@@ -469,4 +531,278 @@ Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_setWalkerShinyCheat(JNIEnv
     }
 
     emulator->SetWalkerShinyCheat(shiny == JNI_TRUE);
-}
\ No newline at end of file
+}
+
+// Native replacements for firmware routines, by name ("eepromReadToRamAlso",
+// "drawImageToScreen", which only verifies). False if there is no routine by
+// that name.
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_setHleEnabled(JNIEnv *env, jobject thiz,
+                                                                    jstring name,
+                                                                    jboolean enabled) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return JNI_FALSE;
+    }
+
+    const char* nameChars = env->GetStringUTFChars(name, nullptr);
+    const bool found = emulator->SetHleEnabled(nameChars, enabled == JNI_TRUE);
+    env->ReleaseStringUTFChars(name, nameChars);
+
+    return found ? JNI_TRUE : JNI_FALSE;
+}
+
+// Debugging aid, every call of the routine also runs through the firmware and
+// a mismatch pauses the emulator.
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_setHleVerifying(JNIEnv *env, jobject thiz,
+                                                                      jstring name,
+                                                                      jboolean verifying) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return JNI_FALSE;
+    }
+
+    const char* nameChars = env->GetStringUTFChars(name, nullptr);
+    const bool found = emulator->SetHleVerifying(nameChars, verifying == JNI_TRUE);
+    env->ReleaseStringUTFChars(name, nameChars);
+
+    return found ? JNI_TRUE : JNI_FALSE;
+}
+// Call these between pause() and resume(), the emulator thread must not be
+// stepping while the machine state is copied in or out.
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_saveState(JNIEnv *env, jobject thiz) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return nullptr;
+    }
+
+    const std::vector<uint8_t> state = emulator->SaveState();
+
+    jbyteArray byteArray = env->NewByteArray(static_cast<jsize>(state.size()));
+    env->SetByteArrayRegion(byteArray, 0, static_cast<jsize>(state.size()),
+                            reinterpret_cast<const jbyte*>(state.data()));
+
+    return byteArray;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_loadState(JNIEnv *env, jobject thiz,
+                                                                jbyteArray state_bytes) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator || !state_bytes) {
+        return JNI_FALSE;
+    }
+
+    jsize stateSize = env->GetArrayLength(state_bytes);
+    jbyte* stateBuffer = env->GetByteArrayElements(state_bytes, nullptr);
+    if (!stateBuffer) {
+        return JNI_FALSE;
+    }
+
+    bool loaded = true;
+    try {
+        emulator->LoadState(reinterpret_cast<const uint8_t*>(stateBuffer), static_cast<size_t>(stateSize));
+    } catch (const std::exception& e) {
+        __android_log_print(ANDROID_LOG_ERROR, "PocketWalker", "Failed to load save state: %s", e.what());
+        loaded = false;
+    }
+
+    env->ReleaseByteArrayElements(state_bytes, stateBuffer, JNI_ABORT);
+
+    return loaded ? JNI_TRUE : JNI_FALSE;
+}
+
+// Call after create() and before start(). Restores the boot snapshot for this
+// ROM and EEPROM from cache_dir if there is one, otherwise arms the emulator
+// to write it there once the firmware finishes initializing. Snapshots for
+// other ROM/EEPROM contents are removed when a new one is written.
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_enableInstantBoot(JNIEnv *env, jobject thiz,
+                                                                        jstring cache_dir) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator || !cache_dir) {
+        return JNI_FALSE;
+    }
+
+    const char* cacheDirChars = env->GetStringUTFChars(cache_dir, nullptr);
+    const std::filesystem::path directory(cacheDirChars);
+    env->ReleaseStringUTFChars(cache_dir, cacheDirChars);
+
+    const std::filesystem::path snapshotPath = directory / std::format("boot-{:016x}.state", emulator->GetBootKey());
+
+    if (std::ifstream file(snapshotPath, std::ios::binary); file) {
+        const std::vector<uint8_t> state((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        try {
+            emulator->LoadState(state.data(), state.size());
+            return JNI_TRUE;
+        } catch (const std::exception& e) {
+            __android_log_print(ANDROID_LOG_WARN, "PocketWalker", "Discarding boot snapshot: %s", e.what());
+        }
+    }
+
+    emulator->OnBootSnapshot([directory, snapshotPath](const std::vector<uint8_t>& state) {
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            const std::string name = entry.path().filename().string();
+            if (name.starts_with("boot-") && name.ends_with(".state")) {
+                std::filesystem::remove(entry.path(), error);
+            }
+        }
+
+        // Written under a temporary name so a crash never leaves a partial snapshot behind.
+        std::filesystem::path temporaryPath = snapshotPath;
+        temporaryPath += ".tmp";
+
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(state.data()), static_cast<std::streamsize>(state.size()));
+        file.close();
+
+        if (file) {
+            std::filesystem::rename(temporaryPath, snapshotPath, error);
+        } else {
+            std::filesystem::remove(temporaryPath, error);
+        }
+    });
+
+    return JNI_FALSE;
+}
+
+// Call after create() and before start().
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_enableRewind(JNIEnv *env, jobject thiz,
+                                                                   jint interval_ms,
+                                                                   jint budget_bytes) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator || interval_ms <= 0 || budget_bytes <= 0) {
+        return;
+    }
+
+    emulator->EnableRewind(static_cast<uint32_t>(interval_ms), static_cast<size_t>(budget_bytes));
+}
+
+// Call between pause() and resume().
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_rewindStep(JNIEnv *env, jobject thiz) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return JNI_FALSE;
+    }
+
+    return emulator->RewindStep() ? JNI_TRUE : JNI_FALSE;
+}
+
+// Rebuilds the EEPROM from the base image and journal EepromJournal keeps,
+// null if there is no base image yet. Doesn't need an emulator.
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_recoverEeprom(JNIEnv *env, jobject thiz,
+                                                                    jstring image_path,
+                                                                    jstring journal_path) {
+    const char* imagePathChars = env->GetStringUTFChars(image_path, nullptr);
+    const char* journalPathChars = env->GetStringUTFChars(journal_path, nullptr);
+    const std::filesystem::path imagePath(imagePathChars);
+    const std::filesystem::path journalPath(journalPathChars);
+    env->ReleaseStringUTFChars(image_path, imagePathChars);
+    env->ReleaseStringUTFChars(journal_path, journalPathChars);
+
+    std::vector<uint8_t> eeprom(Eeprom::MEMORY_SIZE);
+    if (!EepromJournal::Recover(imagePath, journalPath, eeprom.data(), eeprom.size())) {
+        return nullptr;
+    }
+
+    jbyteArray byteArray = env->NewByteArray(static_cast<jsize>(eeprom.size()));
+    env->SetByteArrayRegion(byteArray, 0, static_cast<jsize>(eeprom.size()),
+                            reinterpret_cast<const jbyte*>(eeprom.data()));
+
+    return byteArray;
+}
+
+// Call after create() (and enableInstantBoot()) and before start().
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_enableEepromJournal(JNIEnv *env, jobject thiz,
+                                                                          jstring image_path,
+                                                                          jstring journal_path) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return;
+    }
+
+    const char* imagePathChars = env->GetStringUTFChars(image_path, nullptr);
+    const char* journalPathChars = env->GetStringUTFChars(journal_path, nullptr);
+    const std::filesystem::path imagePath(imagePathChars);
+    const std::filesystem::path journalPath(journalPathChars);
+    env->ReleaseStringUTFChars(image_path, imagePathChars);
+    env->ReleaseStringUTFChars(journal_path, journalPathChars);
+
+    emulator->EnableEepromJournal(imagePath, journalPath);
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_flushEepromJournal(JNIEnv *env, jobject thiz) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return 0;
+    }
+
+    return static_cast<jint>(emulator->FlushEepromJournal());
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_compactEepromJournal(JNIEnv *env, jobject thiz) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return;
+    }
+
+    emulator->CompactEepromJournal();
+}
+
+// Like create(), but maps the ROM and EEPROM files instead of copying them.
+// The EEPROM file is written in place, call syncEeprom() to make it durable.
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_createFromFiles(JNIEnv *env, jobject thiz,
+                                                                      jstring rom_path,
+                                                                      jstring eeprom_path) {
+    const char* romPathChars = env->GetStringUTFChars(rom_path, nullptr);
+    const char* eepromPathChars = env->GetStringUTFChars(eeprom_path, nullptr);
+    const std::filesystem::path romPath(romPathChars);
+    const std::filesystem::path eepromPath(eepromPathChars);
+    env->ReleaseStringUTFChars(rom_path, romPathChars);
+    env->ReleaseStringUTFChars(eeprom_path, eepromPathChars);
+
+    try {
+        auto emulator = new PokeWalker(romPath, eepromPath);
+        emulator->SetExceptionHandling(false);
+        PocketWalkerState::SetEmulator(emulator);
+    } catch (const std::exception& e) {
+        __android_log_print(ANDROID_LOG_ERROR, "PocketWalker", "Failed to map emulator files: %s", e.what());
+        return JNI_FALSE;
+    }
+
+    return JNI_TRUE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_halfheart_pocketwalkerlib_PocketWalkerNative_syncEeprom(JNIEnv *env, jobject thiz) {
+    auto emulator = PocketWalkerState::Emulator();
+    if (!emulator) {
+        return;
+    }
+
+    emulator->SyncEeprom();
+}
@@ -7,6 +7,26 @@ const val BUTTON_RIGHT = 1 shl 4
 class PocketWalkerNative {
 
     external fun create(romBytes: ByteArray, eepromBytes: ByteArray)
+
+    // Maps the files instead of copying them. The EEPROM file is updated in
+    // place, syncEeprom() flushes the pages changed since the last sync.
+    // Don't combine with the EEPROM journal on the same file.
+    external fun createFromFiles(romPath: String, eepromPath: String): Boolean
+    external fun syncEeprom()
+
+    // Call between create() and start(). Returns true if the emulator was
+    // restored from a boot snapshot in cacheDir instead of booting cold.
+    external fun enableInstantBoot(cacheDir: String): Boolean
+
+    // Call between create() and start(). Keeps a snapshot every intervalMs of
+    // emulated time, within budgetBytes of memory.
+    external fun enableRewind(intervalMs: Int, budgetBytes: Int)
+
+    // Only between pause() and resume(). The first call goes back to the
+    // latest snapshot, each further call one snapshot older. Returns false
+    // once there is nothing left.
+    external fun rewindStep(): Boolean
+
     external fun start()
     external fun stop()
     external fun pause()
@@ -15,15 +35,40 @@ class PocketWalkerNative {
     external fun onDraw(callback: (ByteArray) -> Unit)
     external fun onAudio(callback: (Float, Boolean) -> Unit)
 
-    external fun onTransmitSci3(callback: (Byte) -> Unit)
+    // Transmitted IR bytes arrive a packet at a time. receiveSci3Bytes
+    // returns how many bytes fit, never blocking the emulator.
+    external fun onTransmitSci3(callback: (ByteArray) -> Unit)
     external fun receiveSci3(byte: Byte)
+    external fun receiveSci3Bytes(data: ByteArray): Int
+
+    // The same traffic a packet at a time, checksums handled natively. The
+    // callback gets the plain header and payload of every valid packet the
+    // walker sends, and takes over from onTransmitSci3. Anything else, like
+    // the one byte advertisement, reaches onOther still obfuscated.
+    // receiveIrPacket returns false if the packet doesn't fit yet.
+    external fun onTransmitIrPacket(callback: (ByteArray) -> Unit, onOther: (ByteArray) -> Unit)
+    external fun receiveIrPacket(command: Int, extra: Int, session: Int, payload: ByteArray): Boolean
 
     external fun press(button: Int)
     external fun release(button: Int)
 
     external fun getEepromBuffer(): ByteArray
+
+    // Incremental EEPROM saves: a base image plus a journal of written pages.
+    // recoverEeprom works before create() and returns null without an image.
+    // enableEepromJournal goes between create() and start(), flush and
+    // compact can then be called from any thread.
+    external fun recoverEeprom(imagePath: String, journalPath: String): ByteArray?
+    external fun enableEepromJournal(imagePath: String, journalPath: String)
+    external fun flushEepromJournal(): Int
+    external fun compactEepromJournal()
     external fun getContrast(): Byte
 
+    // Only between pause() and resume(). loadState returns false and leaves
+    // the emulator as it was if the blob is not a usable save state.
+    external fun saveState(): ByteArray?
+    external fun loadState(stateBytes: ByteArray): Boolean
+
     external fun setAccelerationData(x: Float, y: Float, z: Float)
 
     external fun addFusedSteps(count: Int)
@@ -32,6 +77,12 @@ class PocketWalkerNative {
 
     external fun setWalkerShinyCheat(shiny: Boolean)
 
+    // Native replacements for firmware routines, by name:
+    // "eepromReadToRamAlso", "drawImageToScreen". The draw is only ever
+    // checked against the firmware, never replaces it.
+    external fun setHleEnabled(name: String, enabled: Boolean): Boolean
+    external fun setHleVerifying(name: String, verifying: Boolean): Boolean
+
     external fun setColorMode(enabled: Boolean)
 
     external fun getColorFrame(): IntArray